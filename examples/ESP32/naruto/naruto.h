@@ -5056,7 +5056,13 @@ const tgx::Mesh3D<tgx::RGB565> naruto_3 =
     0.07790246218370915, 0.1210752484164588
     },
     
-    "naruto" // model name    
+    "naruto", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -5093,7 +5099,13 @@ const tgx::Mesh3D<tgx::RGB565> naruto_2 =
     0.008390761502363614, 0.15907298388304478
     },
     
-    "naruto" // model name    
+    "naruto", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -5130,7 +5142,13 @@ const tgx::Mesh3D<tgx::RGB565> naruto_1 =
     -0.195223555275581, 0.195223555275581
     },
     
-    "naruto" // model name    
+    "naruto", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
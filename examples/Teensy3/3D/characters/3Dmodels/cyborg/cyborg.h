@@ -9764,7 +9764,13 @@ const tgx::Mesh3D<tgx::RGB565> cyborg =
     -0.23075535744826633, 0.23075535744826633
     },
     
-    "cyborg"
+    "cyborg",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -13012,7 +13012,13 @@ const tgx::Mesh3D<tgx::RGB565> stormtrooper =
     -0.2133101767732101, 0.2133101767732101
     },
     
-    "stormtrooper" // model name    
+    "stormtrooper", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -25039,7 +25039,13 @@ const tgx::Mesh3D<tgx::RGB565> buddha =
     -0.3997194496505069, 0.3997194496505069
     },
     
-    "buddha" // model name    
+    "buddha", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -23173,7 +23173,13 @@ const tgx::Mesh3D<tgx::RGB565> R2D2 =
     -0.4650256606529809, 0.4650256606529809
     },
     
-    "R2D2" // model name    
+    "R2D2", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
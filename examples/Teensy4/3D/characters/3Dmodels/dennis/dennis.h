@@ -15218,7 +15218,13 @@ const tgx::Mesh3D<tgx::RGB565> dennis =
     -0.2433156622798864, 0.2433156622798864
     },
     
-    "dennis" // model name    
+    "dennis", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
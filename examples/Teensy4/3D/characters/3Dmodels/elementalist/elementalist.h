@@ -18944,7 +18944,13 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_7 =
     0.02161907261211315, 0.3199721987616645
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -18981,7 +18987,13 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_6 =
     -0.3199721987616645, 0.1916991644730886
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19018,7 +19030,13 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_5 =
     -0.06286918864160121, 0.16142148442110738
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19055,7 +19073,13 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_4 =
     -0.10615798575100582, 0.19640681027201895
     },
 
-    "elementalist"  
+    "elementalist",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19092,7 +19116,13 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_3 =
     -0.13178738126315714, 0.1775445982973174
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19129,7 +19159,13 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_2 =
     -0.035130520281954486, 0.15356081606833646
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19166,7 +19202,13 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_1 =
     -0.08171168992795284, 0.1526399143731027
     },
     
-    "elementalist"
+    "elementalist",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
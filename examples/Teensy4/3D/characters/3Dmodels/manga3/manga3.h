@@ -39205,7 +39205,13 @@ const tgx::Mesh3D<tgx::RGB565> manga3_4  =
     -0.44403845697568856, 0.07555220112548244
     },
     
-    "manga3" // model name    
+    "manga3", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -39243,7 +39249,13 @@ const tgx::Mesh3D<tgx::RGB565> manga3_3  =
     0.11484061153288282, 0.1682972946533991
     },
     
-    "manga3" // model name    
+    "manga3", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -39281,7 +39293,13 @@ const tgx::Mesh3D<tgx::RGB565> manga3_2  =
     -0.18045771367994035, 0.3688488567642489
     },
     
-    "manga3" // model name    
+    "manga3", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -39318,7 +39336,13 @@ const tgx::Mesh3D<tgx::RGB565> manga3_1  =
     -0.3458052672168342, 0.44403845697568856
     },
     
-    "manga3" // model name    
+    "manga3", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -19171,7 +19171,13 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_7 =
     -0.2131597410827449, 0.14424877999361976
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19208,7 +19214,13 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_6 =
     -0.20081687618012986, 0.17553299837045086
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19245,7 +19257,13 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_5 =
     -0.24833138261641796, 0.17269260365743255
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19282,7 +19300,13 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_4 =
     0.04742208987524034, 0.06175177612236276
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19319,7 +19343,13 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_3 =
     0.028202678409766955, 0.09679031625324402
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19356,7 +19386,13 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_2 =
     -0.1649387733547158, 0.10337694963917127
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -19393,7 +19429,13 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_1 =
     0.04684549675383461, 0.24833138261641796
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
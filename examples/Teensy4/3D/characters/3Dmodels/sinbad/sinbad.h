@@ -17563,7 +17563,13 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_7 =
     -0.4190432519475148, -0.05589628727915092
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -17600,7 +17606,13 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_6 =
     -0.08298786169122412, 0.3394074433707943
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -17637,7 +17649,13 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_5 =
     -0.1537991377613615, 0.4190432519475148
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -17674,7 +17692,13 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_4 =
     -0.08427840158557116, 0.29722103446890935
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -17711,7 +17735,13 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_3 =
     0.19579249822650618, 0.2966330133684933
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -17748,7 +17778,13 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_2 =
     0.1948521082553503, 0.3370327257041331
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -17785,7 +17821,13 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_1 =
     -0.14101755609111088, 0.4072133768809186
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -6266,7 +6266,13 @@ const tgx::Mesh3D<tgx::RGB565> bunny =
     -0.7759365864222039, 0.7759365864222039
     },
     
-    "Stanford bunny" // model name    
+    "Stanford bunny", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -27444,7 +27444,13 @@ const tgx::Mesh3D<tgx::RGB565> dragon =
     -1.0, 1.0
     },
     
-    "Stanford dragon" // model name    
+    "Stanford dragon", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -11935,7 +11935,13 @@ const tgx::Mesh3D<tgx::RGB565> skull_4 =
     -0.29619090141314813, 0.29619090141314813
     },
     
-    "skull" // model name    
+    "skull", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -11972,7 +11978,13 @@ const tgx::Mesh3D<tgx::RGB565> skull_3 =
     -0.5192714244985127, 0.5192714244985127
     },
     
-    "skull" // model name    
+    "skull", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -12009,7 +12021,13 @@ const tgx::Mesh3D<tgx::RGB565> skull_2 =
     -0.25993749226722324, 0.25993749226722324
     },
     
-    "skull" // model name    
+    "skull", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
 
@@ -12046,7 +12064,13 @@ const tgx::Mesh3D<tgx::RGB565> skull_1 =
     -0.67750098172644, 0.67750098172644
     },
     
-    "skull" // model name    
+    "skull", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -31039,7 +31039,13 @@ const tgx::Mesh3D<tgx::RGB565> suzanne =
     -0.603744390103135, 0.603744390103135
     },
     
-    "Suzanne (blender's monkey)" // model name    
+    "Suzanne (blender's monkey)", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -2745,7 +2745,13 @@ const tgx::Mesh3D<tgx::RGB565> teapot =
     -0.62211977983181, 0.62211977983181
     },
     
-    "Utah teapot" // model name    
+    "Utah teapot", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
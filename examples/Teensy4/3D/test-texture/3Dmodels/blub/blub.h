@@ -25117,7 +25117,13 @@ const tgx::Mesh3D<tgx::RGB565> blub =
     -1.0f, 1.0f
     },
     
-    "blub" // model name    
+    "blub", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -18208,7 +18208,13 @@ const tgx::Mesh3D<tgx::RGB565> bob =
     -0.788369683460517f, 0.788369683460517f
     },
     
-    "bob" // model name    
+    "bob", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
@@ -10540,7 +10540,13 @@ const tgx::Mesh3D<tgx::RGB565> spot =
     -1.0, 1.0
     },
     
-    "spot" // model name    
+    "spot", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    nullptr, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     };
     
                 
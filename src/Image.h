@@ -30,8 +30,10 @@
 #include "Color.h"
 
 #include "ShaderParams.h"
+#include "Trace.h"
 
 #include <stdint.h>
+#include <string.h>
 
 
 namespace tgx
@@ -592,6 +594,29 @@ namespace tgx
 			}
 
 
+		/**
+		* Copy the source image pixels into this image using a 4x4 tiled layout.
+		*
+		* The pixels are stored by blocks of 4x4 pixels: the blocks are in row-major order and
+		* the pixels inside a block are also in row-major order (see texelIndex<true>()). The
+		* resulting image can be used as a texture by Renderer3D when tiled textures are enabled
+		* with Renderer3D::useTiledTextures(). With this layout, a texture sampled along any
+		* direction touches fewer cache lines than with the usual row-major layout.
+		*
+		* - the source image width and height must be multiples of 4 (textures have power of
+		*   two dimensions anyway so any texture with size at least 4x4 can be converted).
+		* - this image must have the same width and height as the source and its stride must
+		*   be equal to its width.
+		*
+		* Return true if the copy was performed and false otherwise.
+		*
+		* Remark: the tiled image should only be used as a texture. Its pixels are not at their
+		*         usual place so drawing onto it or drawing it onto another image does not give
+		*         the expected result.
+		**/
+		bool copyTiled(const Image<color_t> & src_image);
+
+
 
 	/****************************************************************************
 	* 
@@ -2349,6 +2374,7 @@ private:
 	template<typename color_t>
 	void Image<color_t>::_blit(const Image& sprite, int dest_x, int dest_y, int sprite_x, int sprite_y, int sx, int sy)
 		{
+		TGX_TRACE_SCOPE("Image::blit");
 		if (!_blitClip(sprite, dest_x, dest_y, sprite_x, sprite_y, sx, sy)) return;
 		_blitRegion(_buffer + TGX_CAST32(dest_y) * TGX_CAST32(_stride) + TGX_CAST32(dest_x), _stride, sprite._buffer + TGX_CAST32(sprite_y) * TGX_CAST32(sprite._stride) + TGX_CAST32(sprite_x), sprite._stride, sx, sy);
 		}
@@ -2357,6 +2383,7 @@ private:
 	template<typename color_t>
 	void Image<color_t>::_blit(const Image& sprite, int dest_x, int dest_y, int sprite_x, int sprite_y, int sx, int sy, float opacity)
 		{
+		TGX_TRACE_SCOPE("Image::blit");
 		if (opacity < 0.0f) opacity = 0.0f; else if (opacity > 1.0f) opacity = 1.0f;
 		if (!_blitClip(sprite, dest_x, dest_y, sprite_x, sprite_y, sx, sy)) return;
 		_blendRegion(_buffer + TGX_CAST32(dest_y) * TGX_CAST32(_stride) + TGX_CAST32(dest_x), _stride, sprite._buffer + TGX_CAST32(sprite_y) * TGX_CAST32(sprite._stride) + TGX_CAST32(sprite_x), sprite._stride, sx, sy, opacity);
@@ -2366,6 +2393,7 @@ private:
 	template<typename color_t>
 	void Image<color_t>::_blitMasked(const Image& sprite, color_t transparent_color, int dest_x, int dest_y, int sprite_x, int sprite_y, int sx, int sy, float opacity)
 		{
+		TGX_TRACE_SCOPE("Image::blitMasked");
 		if (opacity < 0.0f) opacity = 0.0f; else if (opacity > 1.0f) opacity = 1.0f;
 		if (!_blitClip(sprite, dest_x, dest_y, sprite_x, sprite_y, sx, sy)) return;
 		_maskRegion(transparent_color, _buffer + TGX_CAST32(dest_y) * TGX_CAST32(_stride) + TGX_CAST32(dest_x), _stride, sprite._buffer + TGX_CAST32(sprite_y) * TGX_CAST32(sprite._stride) + TGX_CAST32(sprite_x), sprite._stride, sx, sy, opacity);
@@ -2398,6 +2426,25 @@ private:
 
 
 
+	template<typename color_t>
+	bool Image<color_t>::copyTiled(const Image<color_t>& src_image)
+		{
+		if ((!isValid()) || (!src_image.isValid())) return false;
+		if ((_lx != src_image._lx) || (_ly != src_image._ly) || (_stride != _lx)) return false;
+		if ((_lx & 3) || (_ly & 3)) return false;
+		for (int j = 0; j < _ly; j++)
+			{
+			const color_t* p_src = src_image._buffer + TGX_CAST32(j) * TGX_CAST32(src_image._stride);
+			for (int i = 0; i < _lx; i++)
+				{
+				_buffer[texelIndex<true>(i, j, _stride)] = p_src[i];
+				}
+			}
+		return true;
+		}
+
+
+
 	template<typename color_t>
 	Image<color_t> Image<color_t>::copyReduceHalf(const Image<color_t>& src_image)
 		{
@@ -3818,6 +3865,7 @@ private:
 	template<bool BLEND>
 	iVec2 Image<color_t>::_drawTextGFX(const char* text, iVec2 pos, color_t col, const GFXfont& font, bool start_newline_at_0, float opacity)
 		{
+		TGX_TRACE_SCOPE("Image::drawText");
 		const int startx = start_newline_at_0 ? 0 : pos.x;
 		const size_t l = strlen(text);
 		for (size_t i = 0; i < l; i++)
@@ -3971,6 +4019,7 @@ private:
 	template<bool BLEND>
 	iVec2 Image<color_t>::_drawTextILI(const char* text, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, bool start_newline_at_0, float opacity)
 		{
+		TGX_TRACE_SCOPE("Image::drawText");
 		const int startx = start_newline_at_0 ? 0 : pos.x;
 		const size_t l = strlen(text);
 		for (size_t i = 0; i < l; i++)
@@ -24,6 +24,7 @@
 
 
 #include <stdint.h>
+#include <string.h>
 #include <type_traits>
 
 #include "Misc.h"
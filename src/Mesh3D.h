@@ -26,16 +26,100 @@
 #include "Misc.h"
 #include "Vec2.h"
 #include "Vec3.h"
+#include "Box2.h"
 #include "Box3.h"
 #include "Color.h"
 #include "Image.h"
+#include "Mipmap.h"
 
 #include <stdint.h>
+#include <string.h>
 
 
 namespace tgx
 {
 
+
+    /**
+    * Compact (quantized) vertex attributes of a mesh. See Mesh3D::compact.
+    *
+    * vertice       array of quantized vertices: 3 int16_t (x,y,z) per vertex. A value q is
+    *               mapped to min + (q + 32768) * (max - min) / 65535 where [min, max] is the
+    *               range of the corresponding coordinate in vertice_box.
+    *
+    * vertice_box   box used for dequantizing the vertices. It usually contains the bounding
+    *               boxes of all the meshes chained together (since they share the same arrays).
+    *
+    * texcoord      array of quantized texture coords: 2 uint16_t (u,v) per texture coord (or
+    *               nullptr if none). A value q is mapped to min + q * (max - min) / 65535 where
+    *               [min, max] is the range of the corresponding coordinate in texcoord_box.
+    *
+    * texcoord_box  box used for dequantizing the texture coords: [minX,maxX] for u and
+    *               [minY,maxY] for v.
+    *
+    * normal16      array of normals with 16 bit octahedral encoding (8 bits per coordinate,
+    *               x in the high byte) or nullptr.
+    *
+    * normal32      array of normals with 32 bit octahedral encoding (16 bits per coordinate,
+    *               x in the high half) or nullptr. Only one of normal16 or normal32 may be set.
+    *
+    * Compared to the fVec3/fVec2 arrays of Mesh3D, the vertices take half the memory, the texture
+    * coords also half and the normals 1/6 (16 bit) or 1/3 (32 bit) of it.
+    **/
+    struct Mesh3DCompact
+        {
+        const int16_t* vertice;             // quantized vertex array (3 int16_t per vertex).
+        fBox3 vertice_box;                  // range of the vertices.
+        const uint16_t* texcoord;           // quantized texture coord array (2 uint16_t per texture coord) or nullptr.
+        fBox2 texcoord_box;                 // range of the texture coords.
+        const uint16_t* normal16;           // 16 bit octahedral normals or nullptr.
+        const uint32_t* normal32;           // 32 bit octahedral normals or nullptr.
+        };
+
+
+
+    /**
+    * Cluster of triangles of a mesh (meshlet).
+    *
+    * A cluster is a range of consecutive chains in the face array of a mesh (typically 64 to 128
+    * triangles close to each other) together with a bounding sphere and a cone containing the
+    * normals of its triangles. The renderer tests each cluster before transforming any of its
+    * vertices and skips it entirely if the sphere is outside of the view frustum or if all
+    * its triangles face away from the camera (when back face culling is enabled).
+    *
+    * face_start    offset in the face array of the first chain of the cluster.
+    *
+    * face_end      offset in the face array just after the last chain of the cluster (i.e. the
+    *               face_start of the next cluster or the position of the end tag).
+    *
+    * nb_faces      number of triangles in the cluster.
+    *
+    * center        center of the bounding sphere.
+    *
+    * radius        radius of the bounding sphere.
+    *
+    * cone_axis     unit vector: mean direction of the normals of the (CCW) triangles.
+    *
+    * cone_cutoff   sine of the largest angle between cone_axis and the normal of a triangle of
+    *               the cluster. Set to 1 when this angle is 90 degrees or more (in which case
+    *               the cluster is never culled by the normal cone test).
+    *
+    * The clusters of a mesh must be sorted by increasing face_start and cover all the chains.
+    * Clusters can be created at runtime with createMeshClusters() (see MeshCluster.h).
+    **/
+    struct Mesh3DCluster
+        {
+        uint16_t face_start;                // offset of the first chain of the cluster in the face array.
+        uint16_t face_end;                  // offset after the last chain of the cluster in the face array.
+        uint16_t nb_faces;                  // number of triangles in the cluster.
+        fVec3 center;                       // bounding sphere center.
+        float radius;                       // bounding sphere radius.
+        fVec3 cone_axis;                    // normal cone axis (unit vector).
+        float cone_cutoff;                  // sine of the normal cone half angle (1 if the cone is not usable).
+        };
+
+
+
     /**
     * Structure containing the information about a 3D mesh
     *
@@ -77,6 +161,30 @@ namespace tgx
     * specular_exponent     specular lightning component.
     *
     * next      pointer to the next mesh to draw.
+    *
+    * lod       pointer to a version of this mesh with a lower level of detail (i.e.
+    *           with less triangles) or nullptr if none. The renderer may draw it instead
+    *           of this mesh when the mesh is small on the screen. This member may be omitted
+    *           in the initializer list of a mesh (it is then set to nullptr). LOD chains
+    *           can be created at runtime with createMeshLOD() (see MeshLOD.h).
+    *
+    * mipmap    pointer to the mip chain of the texture (see Mipmap.h) or nullptr if none.
+    *           When set (and texturing is used), the renderer selects the texture level for
+    *           each triangle according to its size on the screen. This member may also be
+    *           omitted in the initializer list of a mesh.
+    *
+    * compact   pointer to the compact (quantized) vertex attributes of the mesh or nullptr if
+    *           none (see Mesh3DCompact). When set, the renderer reads the vertices, normals and
+    *           texture coords from it and the vertice, normal and texcoord arrays above are
+    *           ignored (they should be set to nullptr to save memory). This member may also be
+    *           omitted in the initializer list. Meshes without the float arrays cannot be
+    *           simplified: createMeshLOD() returns nullptr for them.
+    *
+    * nb_clusters   number of clusters of triangles of the mesh (see Mesh3DCluster) or 0 if
+    * cluster       none, and pointer to the cluster array. When set, the renderer culls whole
+    *               clusters against the view frustum and with their normal cone before
+    *               transforming their vertices. These members may also be omitted in the
+    *               initializer list. Use createMeshClusters() (see MeshCluster.h) to create them.
     * 
     * 
     * 
@@ -186,6 +294,155 @@ namespace tgx
         fBox3 bounding_box;                 // object bounding box.
         
         const char* name;                   // mesh name
+
+        const Mesh3D * lod;                 // lower level of detail version of this mesh (nullptr if none).
+
+        const Mipmap<color_t>* mipmap;      // mip chain of the texture (nullptr if none).
+
+        const Mesh3DCompact* compact;       // compact vertex attributes (nullptr if none).
+
+        uint16_t nb_clusters;               // number of clusters in the cluster array.
+        const Mesh3DCluster* cluster;       // clusters of triangles (nullptr if none).
+        };
+
+
+
+    /**
+    * Encode a unit vector with the octahedral mapping on 2x8 bits (16 bit version)
+    * or 2x16 bits (32 bit version). The first coordinate is stored in the high bits.
+    **/
+    inline uint16_t encodeNormal16(const fVec3& N)
+        {
+        const float s = fabsf(N.x) + fabsf(N.y) + fabsf(N.z);
+        float x = (s > 0) ? (N.x / s) : 0.0f;
+        float y = (s > 0) ? (N.y / s) : 0.0f;
+        if (N.z < 0)
+            {
+            const float ox = x;
+            x = (1.0f - fabsf(y)) * ((ox >= 0) ? 1.0f : -1.0f);
+            y = (1.0f - fabsf(ox)) * ((y >= 0) ? 1.0f : -1.0f);
+            }
+        const int qx = (int)roundf((x + 1.0f) * 127.5f);
+        const int qy = (int)roundf((y + 1.0f) * 127.5f);
+        return (uint16_t)((qx << 8) | qy);
+        }
+
+
+    /** 32 bit version */
+    inline uint32_t encodeNormal32(const fVec3& N)
+        {
+        const float s = fabsf(N.x) + fabsf(N.y) + fabsf(N.z);
+        float x = (s > 0) ? (N.x / s) : 0.0f;
+        float y = (s > 0) ? (N.y / s) : 0.0f;
+        if (N.z < 0)
+            {
+            const float ox = x;
+            x = (1.0f - fabsf(y)) * ((ox >= 0) ? 1.0f : -1.0f);
+            y = (1.0f - fabsf(ox)) * ((y >= 0) ? 1.0f : -1.0f);
+            }
+        const uint32_t qx = (uint32_t)roundf((x + 1.0f) * 32767.5f);
+        const uint32_t qy = (uint32_t)roundf((y + 1.0f) * 32767.5f);
+        return ((qx << 16) | qy);
+        }
+
+
+    /**
+    * Decode a normal encoded with the octahedral mapping where (x,y) are the two coordinates
+    * already mapped back to [-1,1]. Return a unit vector.
+    **/
+    TGX_INLINE inline fVec3 decodeNormalOct(float x, float y)
+        {
+        const float z = 1.0f - fabsf(x) - fabsf(y);
+        const float t = max(-z, 0.0f);
+        x += (x >= 0) ? -t : t;
+        y += (y >= 0) ? -t : t;
+        fVec3 N(x, y, z);
+        N.normalize();
+        return N;
+        }
+
+
+    /** decode a 16 bit octahedral normal */
+    TGX_INLINE inline fVec3 decodeNormal16(const uint16_t v)
+        {
+        return decodeNormalOct(((v >> 8) * (2.0f / 255.0f)) - 1.0f, ((v & 255) * (2.0f / 255.0f)) - 1.0f);
+        }
+
+
+    /** decode a 32 bit octahedral normal */
+    TGX_INLINE inline fVec3 decodeNormal32(const uint32_t v)
+        {
+        return decodeNormalOct(((v >> 16) * (2.0f / 65535.0f)) - 1.0f, ((v & 65535) * (2.0f / 65535.0f)) - 1.0f);
+        }
+
+
+
+    /**
+    * Read the vertices, normals and texture coords of a mesh, either from the fVec3/fVec2 arrays
+    * or from the compact arrays (when mesh->compact is set) in which case they are dequantized
+    * on the fly. The dequantization factors are computed once by the constructor.
+    **/
+    template<typename color_t> class MeshReader
+        {
+        public:
+
+            MeshReader(const Mesh3D<color_t>* mesh)
+                {
+                _c = mesh->compact;
+                _vert = mesh->vertice;
+                _norm = mesh->normal;
+                _tex = mesh->texcoord;
+                if (_c)
+                    {
+                    const fBox3& B = _c->vertice_box;
+                    _vs = fVec3((B.maxX - B.minX) / 65535.0f, (B.maxY - B.minY) / 65535.0f, (B.maxZ - B.minZ) / 65535.0f);
+                    _vo = fVec3(B.minX + 32768.0f * _vs.x, B.minY + 32768.0f * _vs.y, B.minZ + 32768.0f * _vs.z);
+                    const fBox2& T = _c->texcoord_box;
+                    _ts = fVec2((T.maxX - T.minX) / 65535.0f, (T.maxY - T.minY) / 65535.0f);
+                    _to = fVec2(T.minX, T.minY);
+                    }
+                }
+
+            /** true if the mesh has vertices */
+            bool hasVertices() const { return (_c) ? (_c->vertice != nullptr) : (_vert != nullptr); }
+
+            /** true if the mesh has normals */
+            bool hasNormals() const { return (_c) ? ((_c->normal16 != nullptr) || (_c->normal32 != nullptr)) : (_norm != nullptr); }
+
+            /** true if the mesh has texture coords */
+            bool hasTexcoords() const { return (_c) ? (_c->texcoord != nullptr) : (_tex != nullptr); }
+
+            /** vertex i */
+            TGX_INLINE fVec3 vertex(const int i) const
+                {
+                if (_c == nullptr) return _vert[i];
+                const int16_t* q = _c->vertice + (3 * i);
+                return fVec3(_vo.x + q[0] * _vs.x, _vo.y + q[1] * _vs.y, _vo.z + q[2] * _vs.z);
+                }
+
+            /** normal i */
+            TGX_INLINE fVec3 normal(const int i) const
+                {
+                if (_c == nullptr) return _norm[i];
+                return (_c->normal16) ? decodeNormal16(_c->normal16[i]) : decodeNormal32(_c->normal32[i]);
+                }
+
+            /** texture coord i */
+            TGX_INLINE fVec2 texcoord(const int i) const
+                {
+                if (_c == nullptr) return _tex[i];
+                const uint16_t* q = _c->texcoord + (2 * i);
+                return fVec2(_to.x + q[0] * _ts.x, _to.y + q[1] * _ts.y);
+                }
+
+        private:
+
+            const Mesh3DCompact* _c;    // compact arrays (or nullptr)
+            const fVec3* _vert;         // float arrays
+            const fVec3* _norm;         //
+            const fVec2* _tex;          //
+            fVec3 _vs, _vo;             // vertex dequantization: scale and offset
+            fVec2 _ts, _to;             // texcoord dequantization: scale and offset
         };
 
 
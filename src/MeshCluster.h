@@ -0,0 +1,675 @@
+/** @file MeshCluster.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+#ifndef _TGX_MESHCLUSTER_H_
+#define _TGX_MESHCLUSTER_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec3.h"
+#include "Mesh3D.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+namespace tgx
+{
+
+
+    /**
+    * Create a copy of a mesh whose triangles are grouped in clusters (see Mesh3DCluster).
+    *
+    * The triangles of each mesh linked via ->next are partitioned into clusters of at most
+    * 'max_faces' triangles (typically 64 to 128). Clusters are grown from adjacent triangles whose
+    * normals are within 'max_angle' degrees of the mean normal of the cluster and the clusters
+    * that end up with less than max_faces/2 triangles are then merged with their neighbours. A
+    * smaller angle gives tighter normal cones (so more clusters are culled when facing away from
+    * the camera) but the merged clusters have wider cones anyway.
+    *
+    * The chains of triangles of the face array are rebuilt inside each cluster. The bounding
+    * sphere and normal cone of each cluster are computed. Renderer3D::drawMesh() then rejects
+    * whole clusters against the view frustum and with their normal cone (when back face culling
+    * is enabled) before transforming any of their vertices.
+    *
+    * - The copies share their vertex, texcoord and normal arrays, texture, material, bounding box
+    *   and levels of detail with the source mesh (which must therefore remain valid). The levels
+    *   of detail are not clustered.
+    *
+    * - Each mesh of the returned chain occupies a single memory block (mesh, face array and
+    *   cluster array) allocated with malloc(). Release the chain with freeMeshClusters().
+    *
+    * Return nullptr if a mesh is invalid, if its re-encoded face array is too long (more than
+    * 65535 uint16_t) or if memory allocation failed (nothing is allocated in that case).
+    **/
+    template<typename color_t> Mesh3D<color_t>* createMeshClusters(const Mesh3D<color_t>* mesh, int max_faces = 96, float max_angle = 60.0f);
+
+
+    /**
+    * Release a mesh created with createMeshClusters() (together with its chained meshes).
+    **/
+    template<typename color_t> void freeMeshClusters(Mesh3D<color_t>* mesh);
+
+
+
+
+
+
+
+
+
+    /*******************************************************************************************
+    *
+    * Implementation details
+    *
+    ********************************************************************************************/
+
+
+    /**
+    * Partition the triangles of a mesh into clusters (used by createMeshClusters()).
+    *
+    * Clusters are grown triangle by triangle and the chains of the face array are then rebuilt
+    * inside each cluster. Non templated class that works on the decoded triangle list. All
+    * buffers are allocated with malloc() and released by the destructor.
+    **/
+    class _MeshClusterBuilder
+        {
+
+        public:
+
+            _MeshClusterBuilder() : _nbv(0), _nbt(0), _nbc(0), _has_tex(false), _has_norm(false),
+                                    _pos(nullptr), _tri(nullptr), _adj_start(nullptr), _adj(nullptr), _order(nullptr),
+                                    _clusters(nullptr), _out_face(nullptr), _out_len(0)
+                {
+                }
+
+
+            ~_MeshClusterBuilder()
+                {
+                free(_pos); free(_tri); free(_adj_start); free(_adj); free(_order); free(_clusters); free(_out_face);
+                }
+
+
+            /** decode a mesh (the vertex positions are read from 'vert'). Return false on error. */
+            bool load(const fVec3* vert, int nbv, const uint16_t* face, bool has_tex, bool has_norm)
+                {
+                if ((vert == nullptr) || (face == nullptr) || (nbv <= 0)) return false;
+                _nbv = nbv;
+                _has_tex = has_tex;
+                _has_norm = has_norm;
+                const int es = _elemSize();
+
+                // count the triangles
+                _nbt = 0;
+                const uint16_t* f = face;
+                int nbt;
+                while ((nbt = *(f++)) > 0)
+                    {
+                    _nbt += nbt;
+                    f += (nbt + 2) * es;
+                    }
+                if (_nbt == 0) return false;
+
+                _pos = (fVec3*)malloc(sizeof(fVec3) * _nbv);
+                _tri = (_Tri*)malloc(sizeof(_Tri) * _nbt);
+                _adj_start = (int32_t*)malloc(sizeof(int32_t) * (_nbv + 1));
+                _adj = (int32_t*)malloc(sizeof(int32_t) * 3 * _nbt);
+                _order = (int32_t*)malloc(sizeof(int32_t) * _nbt);
+                _clusters = (_Cluster*)malloc(sizeof(_Cluster) * _nbt); // at most one cluster per triangle
+                if ((!_pos) || (!_tri) || (!_adj_start) || (!_adj) || (!_order) || (!_clusters)) return false;
+                memcpy(_pos, vert, sizeof(fVec3) * _nbv);
+
+                // decode the chains of triangles.
+                int k = 0;
+                f = face;
+                while ((nbt = *(f++)) > 0)
+                    {
+                    _Corner c0, c1, c2;
+                    f = _readElem(f, c0);
+                    f = _readElem(f, c1);
+                    f = _readElem(f, c2);
+                    if ((c0.v >= _nbv) || (c1.v >= _nbv) || (c2.v >= _nbv)) return false;
+                    _setTri(k++, c0, c1, c2);
+                    while (--nbt > 0)
+                        {
+                        _Corner c3;
+                        const bool dbit = ((*f) & 32768) != 0;
+                        f = _readElem(f, c3);
+                        if (c3.v >= _nbv) return false;
+                        if (dbit) { c0 = c2; c2 = c3; } else { c1 = c2; c2 = c3; }
+                        _setTri(k++, c0, c1, c2);
+                        }
+                    }
+                return true;
+                }
+
+
+            /**
+            * Partition the triangles into clusters. Each cluster starts from the first triangle not
+            * yet assigned (in face array order) and absorbs the triangles sharing a vertex with it
+            * (breadth first) as long as their normals are within max_angle of the mean normal of the
+            * cluster and the cluster has less than max_faces triangles. The clusters left with less
+            * than max_faces/2 triangles are then merged with their neighbours (see _mergeClusters()).
+            **/
+            bool build(int max_faces, float max_angle)
+                {
+                const float mindot = cosf(max_angle * 0.017453292f);
+                _buildAdjacency();
+                for (int t = 0; t < _nbt; t++) _tri[t].cluster = -1;
+                _nbc = 0;
+                int nbo = 0;
+                for (int seed = 0; seed < _nbt; seed++)
+                    {
+                    if (_tri[seed].cluster >= 0) continue;
+                    const int c = _nbc++;
+                    const int start = nbo;
+                    fVec3 sumN = _tri[seed].N;
+                    _tri[seed].cluster = c;
+                    _order[nbo++] = seed;
+                    // the triangles of the cluster in _order[start..nbo) also serve as the BFS queue.
+                    for (int q = start; (q < nbo) && (nbo - start < max_faces); q++)
+                        {
+                        const _Tri& T = _tri[_order[q]];
+                        for (int k = 0; (k < 3) && (nbo - start < max_faces); k++)
+                            {
+                            const int v = T.c[k].v;
+                            for (int i = _adj_start[v]; (i < _adj_start[v + 1]) && (nbo - start < max_faces); i++)
+                                {
+                                _Tri& U = _tri[_adj[i]];
+                                if ((U.cluster >= 0) || (!_accept(sumN, U.N, mindot))) continue; // already used or too far from the mean normal
+                                U.cluster = c;
+                                sumN += U.N;
+                                _order[nbo++] = _adj[i];
+                                }
+                            }
+                        }
+                    _clusters[c].first = start;
+                    _clusters[c].nb = nbo - start;
+                    _computeBounds(_clusters[c]);
+                    }
+                return _mergeClusters(max_faces);
+                }
+
+
+            /**
+            * Encode the face array cluster after cluster (in an internal buffer). The chains are rebuilt
+            * greedily inside each cluster (as in _MeshSimplifier::encode()). Return false on error.
+            **/
+            bool encode()
+                {
+                const int es = _elemSize();
+                // sort the directed edges of the triangles
+                _DEdge* de = (_DEdge*)malloc(sizeof(_DEdge) * 3 * _nbt);
+                _out_face = (uint16_t*)malloc(sizeof(uint16_t) * (_nbt * (1 + 3 * es) + 1));
+                if ((!de) || (!_out_face)) { free(de); return false; }
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    for (int e = 0; e < 3; e++)
+                        {
+                        de[3 * t + e].ka = _key(_tri[t].c[e]);
+                        de[3 * t + e].kb = _key(_tri[t].c[(e + 1) % 3]);
+                        de[3 * t + e].tri = t;
+                        de[3 * t + e].e = e;
+                        }
+                    _tri[t].done = false;
+                    }
+                const int nbe = 3 * _nbt;
+                qsort(de, nbe, sizeof(_DEdge), _cmpDEdge);
+                // greedy construction of the chains
+                int pos = 0;
+                for (int c = 0; c < _nbc; c++)
+                    {
+                    _Cluster& C = _clusters[c];
+                    C.face_start = pos;
+                    while (true)
+                        {
+                        // start the chain with the triangle having the fewest free neighbours
+                        int st = -1, nbn = 4;
+                        for (int i = C.first; (i < C.first + C.nb) && (nbn > 0); i++)
+                            {
+                            const _Tri& U = _tri[_order[i]];
+                            if (U.done) continue;
+                            int n = 0;
+                            for (int e = 0; e < 3; e++) if (_lookup(de, nbe, c, U.c[(e + 1) % 3], U.c[e]) >= 0) n++;
+                            if (n < nbn) { nbn = n; st = _order[i]; }
+                            }
+                        if (st < 0) break;
+                        _Tri& T = _tri[st];
+                        T.done = true;
+                        // rotate it so that the edge A-B (never followed by the chain) has no free neighbour if possible
+                        int r = 0;
+                        while ((r < 3) && (_lookup(de, nbe, c, T.c[(r + 1) % 3], T.c[r]) >= 0)) r++;
+                        if (r == 3) r = 0;
+                        _Corner A = T.c[r], B = T.c[(r + 1) % 3], D = T.c[(r + 2) % 3];
+                        const int start = pos++;
+                        pos = _writeElem(pos, A, false);
+                        pos = _writeElem(pos, B, false);
+                        pos = _writeElem(pos, D, false);
+                        int len = 1;
+                        while (len < 32767)
+                            {
+                            _Corner E;
+                            if (_findNext(de, nbe, c, A, D, E))
+                                { // next triangle is [A, D, E]
+                                pos = _writeElem(pos, E, false);
+                                B = D; D = E;
+                                }
+                            else if (_findNext(de, nbe, c, D, B, E))
+                                { // next triangle is [D, B, E]
+                                pos = _writeElem(pos, E, true);
+                                A = D; D = E;
+                                }
+                            else break;
+                            len++;
+                            }
+                        _out_face[start] = (uint16_t)len;
+                        }
+                    C.face_end = pos;
+                    }
+                _out_face[pos++] = 0; // end tag
+                _out_len = pos;
+                free(de);
+                return true;
+                }
+
+
+            /** number of triangles. */
+            int nbFaces() const { return _nbt; }
+
+
+            /** number of clusters. */
+            int nbClusters() const { return _nbc; }
+
+
+            /** length of the encoded face array. */
+            int outLenFace() const { return _out_len; }
+
+
+            /** copy the face array of the encoded mesh. */
+            void copyFaces(uint16_t* dst) const
+                {
+                memcpy(dst, _out_face, sizeof(uint16_t) * _out_len);
+                }
+
+
+            /** copy the cluster array. */
+            void copyClusters(Mesh3DCluster* dst) const
+                {
+                for (int c = 0; c < _nbc; c++)
+                    {
+                    const _Cluster& C = _clusters[c];
+                    dst[c].face_start = (uint16_t)C.face_start;
+                    dst[c].face_end = (uint16_t)C.face_end;
+                    dst[c].nb_faces = (uint16_t)C.nb;
+                    dst[c].center = C.center;
+                    dst[c].radius = C.radius;
+                    dst[c].cone_axis = C.axis;
+                    dst[c].cone_cutoff = C.cutoff;
+                    }
+                }
+
+
+        private:
+
+            struct _Corner { uint16_t v, t, n; };                               // corner of a triangle: vertex, texcoord and normal indices
+            struct _Tri { _Corner c[3]; fVec3 N; int32_t cluster; bool done; }; // triangle with its unit normal (0 if degenerate), cluster and 'already encoded' flag
+            struct _DEdge { uint64_t ka, kb; int32_t tri; int32_t e; };         // directed edge between two corners
+            struct _Cluster { int first, nb; int face_start, face_end; fVec3 center; float radius; fVec3 axis; float cutoff; int size, parent; };  // triangles _order[first .. first + nb)
+            struct _Size { int32_t nb, c; };                                    // size of a cluster (for sorting)
+
+            int _elemSize() const { return 1 + (_has_tex ? 1 : 0) + (_has_norm ? 1 : 0); }
+
+            uint64_t _key(const _Corner& c) const { return ((uint64_t)c.v) | (((uint64_t)c.t) << 16) | (((uint64_t)c.n) << 32); }
+
+
+            const uint16_t* _readElem(const uint16_t* f, _Corner& c) const
+                {
+                c.v = (*(f++)) & 32767;
+                c.t = (_has_tex) ? *(f++) : 0;
+                c.n = (_has_norm) ? *(f++) : 0;
+                return f;
+                }
+
+
+            int _writeElem(int pos, const _Corner& c, bool dbit)
+                {
+                _out_face[pos++] = (uint16_t)(c.v | (dbit ? 32768 : 0));
+                if (_has_tex) _out_face[pos++] = c.t;
+                if (_has_norm) _out_face[pos++] = c.n;
+                return pos;
+                }
+
+
+            void _setTri(int k, const _Corner& c0, const _Corner& c1, const _Corner& c2)
+                {
+                _tri[k].c[0] = c0; _tri[k].c[1] = c1; _tri[k].c[2] = c2;
+                fVec3 N = crossProduct(_pos[c1.v] - _pos[c0.v], _pos[c2.v] - _pos[c0.v]);
+                const float l = N.norm();
+                _tri[k].N = (l > 0) ? (N / l) : fVec3(0, 0, 0);
+                }
+
+
+            /** true if the normal N is within the cone of axis sumN (not normalized) and cosine mindot (degenerate triangles are always accepted). */
+            bool _accept(const fVec3& sumN, const fVec3& N, float mindot) const
+                {
+                const float l = sumN.norm();
+                if ((l <= 0) || (N.norm2() <= 0)) return true;
+                return (dotProduct(N, sumN) >= mindot * l);
+                }
+
+
+            /** find a triangle of cluster c not yet encoded with directed edge a->b. Set d to its third corner. */
+            bool _findNext(const _DEdge* de, int nbe, int c, const _Corner& a, const _Corner& b, _Corner& d)
+                {
+                const int i = _lookup(de, nbe, c, a, b);
+                if (i < 0) return false;
+                _Tri& T = _tri[de[i].tri];
+                T.done = true;
+                d = T.c[(de[i].e + 2) % 3];
+                return true;
+                }
+
+
+            /** index in de of the directed edge a->b of a triangle of cluster c not yet encoded (-1 if there is none). */
+            int _lookup(const _DEdge* de, int nbe, int c, const _Corner& a, const _Corner& b) const
+                {
+                const uint64_t ka = _key(a), kb = _key(b);
+                int lo = 0, hi = nbe;
+                while (lo < hi)
+                    {
+                    const int mid = (lo + hi) >> 1;
+                    if ((de[mid].ka < ka) || ((de[mid].ka == ka) && (de[mid].kb < kb))) lo = mid + 1; else hi = mid;
+                    }
+                for (; (lo < nbe) && (de[lo].ka == ka) && (de[lo].kb == kb); lo++)
+                    {
+                    const _Tri& T = _tri[de[lo].tri];
+                    if ((!T.done) && (T.cluster == c)) return lo;
+                    }
+                return -1;
+                }
+
+
+            /** build the vertex -> triangles adjacency lists. */
+            void _buildAdjacency()
+                {
+                memset(_adj_start, 0, sizeof(int32_t) * (_nbv + 1));
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    for (int k = 0; k < 3; k++) _adj_start[_tri[t].c[k].v + 1]++;
+                    }
+                for (int i = 0; i < _nbv; i++) _adj_start[i + 1] += _adj_start[i];
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    for (int k = 0; k < 3; k++) _adj[_adj_start[_tri[t].c[k].v]++] = t;
+                    }
+                for (int i = _nbv; i > 0; i--) _adj_start[i] = _adj_start[i - 1];
+                _adj_start[0] = 0;
+                }
+
+
+            /** cluster into which cluster c was merged (c itself if it was not merged). */
+            int _root(int c) const
+                {
+                while (_clusters[c].parent >= 0) c = _clusters[c].parent;
+                return c;
+                }
+
+
+            /** cost of merging cluster a into cluster b: radius of the merged bounding sphere, larger when the mean normals differ. */
+            float _mergeCost(const _Cluster& a, const _Cluster& b) const
+                {
+                const float d = (a.center - b.center).norm();
+                const float r = max(max(a.radius, b.radius), (d + a.radius + b.radius) * 0.5f);
+                return r * (2.0f - dotProduct(a.axis, b.axis));
+                }
+
+
+            /**
+            * Merge each cluster with less than max_faces/2 triangles (smallest first) with the cluster
+            * sharing a vertex with it (or, if there is none, with any cluster) that minimizes _mergeCost()
+            * as long as the merged cluster has at most max_faces triangles. Small groups of triangles
+            * isolated by the normal cone test thus do not end up in clusters of their own (the normal
+            * cone of the merged cluster is wider but the whole cluster is still culled by a single
+            * frustum test). Then rebuild _order and the bounds of the clusters. Return false on error.
+            **/
+            bool _mergeClusters(int max_faces)
+                {
+                _Size* by_size = (_Size*)malloc(sizeof(_Size) * _nbc);
+                int32_t* remap = (int32_t*)malloc(sizeof(int32_t) * (_nbc + 1));
+                int32_t* order = (int32_t*)malloc(sizeof(int32_t) * _nbt);
+                if ((!by_size) || (!remap) || (!order)) { free(by_size); free(remap); free(order); return false; }
+                for (int c = 0; c < _nbc; c++)
+                    {
+                    _clusters[c].size = _clusters[c].nb;
+                    _clusters[c].parent = -1;
+                    by_size[c].nb = _clusters[c].nb;
+                    by_size[c].c = c;
+                    }
+                qsort(by_size, _nbc, sizeof(_Size), _cmpSize);
+                for (int i = 0; i < _nbc; i++)
+                    {
+                    const int c = by_size[i].c;
+                    _Cluster& A = _clusters[c];
+                    if ((A.parent >= 0) || (2 * A.size >= max_faces)) continue;
+                    int best = -1;
+                    float best_cost = 0;
+                    for (int j = A.first; j < A.first + A.nb; j++)
+                        { // neighbour clusters
+                        const _Tri& T = _tri[_order[j]];
+                        for (int k = 0; k < 3; k++)
+                            {
+                            const int v = T.c[k].v;
+                            for (int l = _adj_start[v]; l < _adj_start[v + 1]; l++)
+                                {
+                                const int d = _root(_tri[_adj[l]].cluster);
+                                if ((d == c) || (A.size + _clusters[d].size > max_faces)) continue;
+                                const float cost = _mergeCost(A, _clusters[d]);
+                                if ((best < 0) || (cost < best_cost)) { best = d; best_cost = cost; }
+                                }
+                            }
+                        }
+                    if (best < 0)
+                        { // isolated cluster
+                        for (int d = 0; d < _nbc; d++)
+                            {
+                            if ((d == c) || (_clusters[d].parent >= 0) || (A.size + _clusters[d].size > max_faces)) continue;
+                            const float cost = _mergeCost(A, _clusters[d]);
+                            if ((best < 0) || (cost < best_cost)) { best = d; best_cost = cost; }
+                            }
+                        if (best < 0) continue;
+                        }
+                    // merge A into B (approximate bounds, recomputed below)
+                    _Cluster& B = _clusters[best];
+                    const fVec3 D = A.center - B.center;
+                    const float d = D.norm();
+                    if (d + A.radius <= B.radius) { }
+                    else if (d + B.radius <= A.radius) { B.center = A.center; B.radius = A.radius; }
+                    else
+                        {
+                        const float r = (d + A.radius + B.radius) * 0.5f;
+                        B.center += D * ((r - B.radius) / d);
+                        B.radius = r;
+                        }
+                    const fVec3 axis = (B.axis * (float)B.size) + (A.axis * (float)A.size);
+                    const float l = axis.norm();
+                    if (l > 0) B.axis = axis / l;
+                    B.size += A.size;
+                    A.parent = best;
+                    }
+                // renumber the clusters and sort the triangles by cluster (keeping their relative order).
+                int nbc = 0;
+                for (int c = 0; c < _nbc; c++) remap[c] = (_clusters[c].parent < 0) ? nbc++ : -1;
+                for (int t = 0; t < _nbt; t++) _tri[t].cluster = remap[_root(_tri[t].cluster)];
+                memset(remap, 0, sizeof(int32_t) * (nbc + 1));
+                for (int t = 0; t < _nbt; t++) remap[_tri[t].cluster + 1]++;
+                for (int c = 0; c < nbc; c++) remap[c + 1] += remap[c];
+                for (int c = 0; c < nbc; c++) { _clusters[c].first = remap[c]; _clusters[c].nb = remap[c + 1] - remap[c]; }
+                for (int i = 0; i < _nbt; i++) order[remap[_tri[_order[i]].cluster]++] = _order[i];
+                free(_order);
+                _order = order;
+                _nbc = nbc;
+                for (int c = 0; c < _nbc; c++) _computeBounds(_clusters[c]);
+                free(by_size);
+                free(remap);
+                return true;
+                }
+
+
+            /** compute the bounding sphere and the normal cone of a cluster. */
+            void _computeBounds(_Cluster& C) const
+                {
+                // bounding sphere centered on the bounding box of the vertices
+                fVec3 m = _pos[_tri[_order[C.first]].c[0].v], M = m;
+                fVec3 A(0, 0, 0);
+                for (int i = C.first; i < C.first + C.nb; i++)
+                    {
+                    const _Tri& T = _tri[_order[i]];
+                    A += T.N;
+                    for (int k = 0; k < 3; k++)
+                        {
+                        const fVec3& V = _pos[T.c[k].v];
+                        m.x = min(m.x, V.x); m.y = min(m.y, V.y); m.z = min(m.z, V.z);
+                        M.x = max(M.x, V.x); M.y = max(M.y, V.y); M.z = max(M.z, V.z);
+                        }
+                    }
+                C.center = (m + M) * 0.5f;
+                float r2 = 0;
+                float mdp = 1.0f;
+                const float l = A.norm();
+                C.axis = (l > 0) ? (A / l) : fVec3(0, 0, 1);
+                for (int i = C.first; i < C.first + C.nb; i++)
+                    {
+                    const _Tri& T = _tri[_order[i]];
+                    for (int k = 0; k < 3; k++) r2 = max(r2, (_pos[T.c[k].v] - C.center).norm2());
+                    if (T.N.norm2() > 0) mdp = min(mdp, dotProduct(T.N, C.axis)); // degenerate triangles are ignored
+                    }
+                C.radius = sqrtf(r2) * 1.0001f; // make sure rounding errors do not leave a vertex outside
+                // normal cone: mean normal and largest deviation from it.
+                C.cutoff = 1.0f;
+                if ((l > 0) && (mdp > 0.001f)) C.cutoff = min(1.0f, sqrtf(1.0f - mdp * mdp) + 0.001f); // small margin for rounding errors
+                }
+
+
+            static int _cmpSize(const void* A, const void* B)
+                {
+                const _Size* a = (const _Size*)A;
+                const _Size* b = (const _Size*)B;
+                if (a->nb != b->nb) return (a->nb < b->nb) ? -1 : 1;
+                return (a->c < b->c) ? -1 : ((a->c > b->c) ? 1 : 0);
+                }
+
+
+            static int _cmpDEdge(const void* A, const void* B)
+                {
+                const _DEdge* a = (const _DEdge*)A;
+                const _DEdge* b = (const _DEdge*)B;
+                if (a->ka != b->ka) return (a->ka < b->ka) ? -1 : 1;
+                if (a->kb != b->kb) return (a->kb < b->kb) ? -1 : 1;
+                return 0;
+                }
+
+
+            int         _nbv;           // number of vertices
+            int         _nbt;           // number of triangles
+            int         _nbc;           // number of clusters
+            bool        _has_tex;       // true if the face array contains texture indices
+            bool        _has_norm;      // true if the face array contains normal indices
+            fVec3*      _pos;           // vertex positions
+            _Tri*       _tri;           // triangles (in face array order)
+            int32_t*    _adj_start;     // start of the adjacency list of each vertex in _adj
+            int32_t*    _adj;           // vertex -> triangles adjacency lists
+            int32_t*    _order;         // triangles sorted by cluster
+            _Cluster*   _clusters;      // clusters
+            uint16_t*   _out_face;      // encoded face array
+            int         _out_len;       // length of the encoded face array
+        };
+
+
+
+    template<typename color_t> Mesh3D<color_t>* createMeshClusters(const Mesh3D<color_t>* mesh, int max_faces, float max_angle)
+        {
+        if (max_faces < 1) max_faces = 1;
+        Mesh3D<color_t>* head = nullptr;
+        Mesh3D<color_t>* prev = nullptr;
+        while (mesh)
+            {
+            const MeshReader<color_t> reader(mesh);
+            if ((!reader.hasVertices()) || (mesh->face == nullptr) || (mesh->nb_vertices == 0)) { freeMeshClusters(head); return nullptr; }
+            fVec3* vert = (fVec3*)malloc(sizeof(fVec3) * mesh->nb_vertices);
+            if (vert == nullptr) { freeMeshClusters(head); return nullptr; }
+            for (int i = 0; i < mesh->nb_vertices; i++) vert[i] = reader.vertex(i);
+
+            _MeshClusterBuilder B;
+            bool ok = B.load(vert, mesh->nb_vertices, mesh->face, reader.hasTexcoords(), reader.hasNormals());
+            free(vert);
+            if (ok)
+                {
+                ok = (B.build(max_faces, max_angle)) && (B.encode()) && (B.outLenFace() <= 65535) && (B.nbClusters() <= 65535); // must fit in Mesh3D::len_face and Mesh3D::nb_clusters
+                }
+            if (!ok) { freeMeshClusters(head); return nullptr; }
+
+            // allocate the mesh, its face array and its cluster array in a single block.
+            const size_t off_c = (sizeof(Mesh3D<color_t>) + 7) & ~((size_t)7);
+            const size_t off_f = off_c + sizeof(Mesh3DCluster) * B.nbClusters();
+            char* mem = (char*)malloc(off_f + sizeof(uint16_t) * B.outLenFace());
+            if (mem == nullptr) { freeMeshClusters(head); return nullptr; }
+            Mesh3D<color_t>* cur = (Mesh3D<color_t>*)mem;
+            memcpy(cur, mesh, sizeof(Mesh3D<color_t>));
+            Mesh3DCluster* clusters = (Mesh3DCluster*)(mem + off_c);
+            uint16_t* face = (uint16_t*)(mem + off_f);
+            B.copyClusters(clusters);
+            B.copyFaces(face);
+            cur->nb_faces = (uint16_t)B.nbFaces();
+            cur->len_face = (uint16_t)B.outLenFace();
+            cur->face = face;
+            cur->nb_clusters = (uint16_t)B.nbClusters();
+            cur->cluster = clusters;
+            cur->next = nullptr;
+            if (prev) prev->next = cur; else head = cur;
+            prev = cur;
+            mesh = mesh->next;
+            }
+        return head;
+        }
+
+
+
+    template<typename color_t> void freeMeshClusters(Mesh3D<color_t>* mesh)
+        {
+        while (mesh)
+            {
+            Mesh3D<color_t>* m = mesh;
+            mesh = (Mesh3D<color_t>*)mesh->next;
+            free(m);
+            }
+        }
+
+
+}
+
+
+#endif
+
+#endif
+
+
+/** end of file */
+
@@ -0,0 +1,740 @@
+/** @file MeshLOD.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+#ifndef _TGX_MESHLOD_H_
+#define _TGX_MESHLOD_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec3.h"
+#include "Mesh3D.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+namespace tgx
+{
+
+
+    /**
+    * Create a simplified version of a mesh with (approximately) a given number of triangles.
+    *
+    * The mesh is simplified by successive edge collapses ordered by their quadric error
+    * metric (Garland & Heckbert): the edges whose removal changes the surface the least
+    * are collapsed first. Mesh borders and texture seams are preserved as much as possible
+    * and collapses that would flip a triangle are rejected (so the target may not be
+    * reached for some meshes).
+    *
+    * - Only the mesh itself is simplified: the meshes linked to it via ->next are ignored
+    *   and the ->next and ->lod fields of the returned mesh are set to nullptr.
+    *
+    * - The new mesh has its own vertex and face arrays (the face array uses the usual chain
+    *   format) but shares its texcoord and normal arrays, texture, material and bounding box
+    *   with the source mesh (which must therefore remain valid).
+    *
+    * - The returned mesh occupies a single memory block allocated with malloc(): release it
+    *   with freeMeshLOD() (or simply free()).
+    *
+    * Return nullptr if the mesh is invalid or if memory allocation failed.
+    **/
+    template<typename color_t> Mesh3D<color_t>* simplifyMesh(const Mesh3D<color_t>* mesh, int target_faces);
+
+
+    /**
+    * Create a copy of a mesh with a chain of lower levels of detail.
+    *
+    * Each mesh linked via ->next is copied and its ->lod field is set to point to a chain of
+    * successively simplified versions of itself (created with simplifyMesh()): the number
+    * of triangles is multiplied by 'ratio' from one level to the next. At most 'nb_levels'
+    * levels are created for each mesh and simplification stops when the number of triangles
+    * would fall below 'min_faces'.
+    *
+    * The returned mesh is drawn by Renderer3D::drawMesh() which automatically selects the
+    * level of detail according to the size of the mesh on the screen (see Renderer3D::setLODDensity()).
+    *
+    * The copies share all their arrays with the source mesh (which must remain valid) except
+    * for the vertex/face arrays of the simplified levels. All memory is allocated with malloc().
+    *
+    * Return nullptr on error (nothing is allocated in that case) and also if one of the
+    * meshes has no vertex or face array (e.g. a mesh that only holds compact attributes,
+    * see Mesh3DCompact): such meshes cannot be simplified. Use freeMeshLOD() to release
+    * the mesh.
+    **/
+    template<typename color_t> Mesh3D<color_t>* createMeshLOD(const Mesh3D<color_t>* mesh, int nb_levels = 3, float ratio = 0.5f, int min_faces = 32);
+
+
+    /**
+    * Release a mesh created with createMeshLOD() or simplifyMesh() (together with its
+    * chained meshes and their levels of detail).
+    **/
+    template<typename color_t> void freeMeshLOD(Mesh3D<color_t>* mesh);
+
+
+
+
+
+
+
+
+
+    /*******************************************************************************************
+    *
+    * Implementation details
+    *
+    ********************************************************************************************/
+
+
+    /**
+    * Quadric error metric mesh simplifier (used by simplifyMesh()).
+    *
+    * Non templated class that works on the decoded triangle list. All buffers are allocated
+    * with malloc() and released by the destructor.
+    **/
+    class _MeshSimplifier
+        {
+
+        public:
+
+            _MeshSimplifier() : _nbv(0), _nbt(0), _alive(0), _has_tex(false), _has_norm(false),
+                                _vert(nullptr), _pos(nullptr), _q(nullptr), _flag(nullptr), _moved(nullptr), _tri(nullptr), _adj_start(nullptr), _adj(nullptr),
+                                _remap(nullptr), _out_nbv(0), _out_face(nullptr), _out_len(0), _center(), _scale(1.0f)
+                {
+                }
+
+
+            ~_MeshSimplifier()
+                {
+                free(_pos); free(_q); free(_flag); free(_moved); free(_tri); free(_adj_start); free(_adj); free(_remap); free(_out_face);
+                }
+
+
+            /** decode a mesh. Return false on error. */
+            bool load(const fVec3* vert, int nbv, const uint16_t* face, bool has_tex, bool has_norm)
+                {
+                if ((vert == nullptr) || (face == nullptr) || (nbv <= 0)) return false;
+                _vert = vert;
+                _nbv = nbv;
+                _has_tex = has_tex;
+                _has_norm = has_norm;
+                const int es = _elemSize();
+
+                // count the triangles
+                _nbt = 0;
+                const uint16_t* f = face;
+                int nbt;
+                while ((nbt = *(f++)) > 0)
+                    {
+                    _nbt += nbt;
+                    f += (nbt + 2) * es;
+                    }
+                if (_nbt == 0) return false;
+
+                _pos = (fVec3*)malloc(sizeof(fVec3) * _nbv);
+                _q = (float*)malloc(sizeof(float) * 10 * _nbv);
+                _flag = (uint8_t*)malloc(_nbv);
+                _moved = (uint8_t*)calloc(_nbv, 1);
+                _tri = (_Tri*)malloc(sizeof(_Tri) * _nbt);
+                _adj_start = (int32_t*)malloc(sizeof(int32_t) * (_nbv + 1));
+                _adj = (int32_t*)malloc(sizeof(int32_t) * 3 * _nbt);
+                _remap = (int32_t*)malloc(sizeof(int32_t) * _nbv);
+                if ((!_pos) || (!_q) || (!_flag) || (!_moved) || (!_tri) || (!_adj_start) || (!_adj) || (!_remap)) return false;
+
+                // normalize the positions to improve the numerical stability of the quadrics.
+                fVec3 m = vert[0], M = vert[0];
+                for (int i = 1; i < _nbv; i++)
+                    {
+                    m.x = min(m.x, vert[i].x); m.y = min(m.y, vert[i].y); m.z = min(m.z, vert[i].z);
+                    M.x = max(M.x, vert[i].x); M.y = max(M.y, vert[i].y); M.z = max(M.z, vert[i].z);
+                    }
+                _center = (m + M) * 0.5f;
+                const float ext = max(max(M.x - m.x, M.y - m.y), M.z - m.z);
+                _scale = (ext > 0) ? (2.0f / ext) : 1.0f;
+                for (int i = 0; i < _nbv; i++) _pos[i] = (vert[i] - _center) * _scale;
+
+                // decode the chains of triangles
+                int k = 0;
+                f = face;
+                while ((nbt = *(f++)) > 0)
+                    {
+                    _Corner c0, c1, c2;
+                    f = _readElem(f, c0);
+                    f = _readElem(f, c1);
+                    f = _readElem(f, c2);
+                    if ((c0.v >= _nbv) || (c1.v >= _nbv) || (c2.v >= _nbv)) return false;
+                    _setTri(k++, c0, c1, c2);
+                    while (--nbt > 0)
+                        {
+                        _Corner c3;
+                        const bool dbit = ((*f) & 32768) != 0;
+                        f = _readElem(f, c3);
+                        if (c3.v >= _nbv) return false;
+                        if (dbit) { c0 = c2; c2 = c3; } else { c1 = c2; c2 = c3; }
+                        _setTri(k++, c0, c1, c2);
+                        }
+                    }
+                _alive = 0;
+                for (int t = 0; t < _nbt; t++) { if (!_tri[t].removed) _alive++; }
+                _computeQuadrics();
+                return true;
+                }
+
+
+            /** collapse edges until the number of triangles is at most target (or no more edges can be collapsed). */
+            bool simplify(int target)
+                {
+                _Edge* edges = (_Edge*)malloc(sizeof(_Edge) * 3 * _nbt);
+                if (!edges) return false;
+                for (int pass = 0; (pass < 100) && (_alive > target); pass++)
+                    {
+                    _buildAdjacency();
+                    // compute the cost of every edge
+                    int nbe = 0;
+                    for (int t = 0; t < _nbt; t++)
+                        {
+                        if (_tri[t].removed) continue;
+                        for (int e = 0; e < 3; e++)
+                            {
+                            fVec3 p;
+                            edges[nbe].cost = _collapseCost(_tri[t].c[e].v, _tri[t].c[(e + 1) % 3].v, p);
+                            edges[nbe].tri = t;
+                            edges[nbe].e = e;
+                            nbe++;
+                            }
+                        }
+                    qsort(edges, nbe, sizeof(_Edge), _cmpEdge);
+                    // collapse the cheapest edges (at most one collapse per vertex per pass)
+                    memset(_flag, 0, _nbv);
+                    int nbc = 0;
+                    for (int i = 0; (i < nbe) && (_alive > target); i++)
+                        {
+                        const _Tri& T = _tri[edges[i].tri];
+                        if (T.removed) continue;
+                        const int a = T.c[edges[i].e].v;
+                        const int b = T.c[(edges[i].e + 1) % 3].v;
+                        if ((_flag[a]) || (_flag[b])) continue;
+                        fVec3 p;
+                        _collapseCost(a, b, p);
+                        if ((_flips(a, b, p)) || (_flips(b, a, p))) continue;
+                        _collapse(a, b, p);
+                        nbc++;
+                        }
+                    if (nbc == 0) break; // stuck
+                    }
+                free(edges);
+                return true;
+                }
+
+
+            /** number of remaining triangles. */
+            int nbFaces() const { return _alive; }
+
+
+            /** encode the remaining triangles in chain format (in an internal buffer). Return false on error. */
+            bool encode()
+                {
+                const int es = _elemSize();
+                // remap the used vertices
+                for (int i = 0; i < _nbv; i++) _remap[i] = -1;
+                _out_nbv = 0;
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    if (_tri[t].removed) continue;
+                    for (int k = 0; k < 3; k++)
+                        {
+                        const int v = _tri[t].c[k].v;
+                        if (_remap[v] < 0) _remap[v] = _out_nbv++;
+                        }
+                    }
+                // sort the directed edges of the remaining triangles
+                _DEdge* de = (_DEdge*)malloc(sizeof(_DEdge) * 3 * _alive);
+                _out_face = (uint16_t*)malloc(sizeof(uint16_t) * (_alive * (1 + 3 * es) + 1));
+                if ((!de) || (!_out_face)) { free(de); return false; }
+                int nbe = 0;
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    if (_tri[t].removed) continue;
+                    for (int e = 0; e < 3; e++)
+                        {
+                        de[nbe].ka = _key(_tri[t].c[e]);
+                        de[nbe].kb = _key(_tri[t].c[(e + 1) % 3]);
+                        de[nbe].tri = t;
+                        de[nbe].e = e;
+                        nbe++;
+                        }
+                    _tri[t].removed = 2; // mark as 'not yet encoded'
+                    }
+                qsort(de, nbe, sizeof(_DEdge), _cmpDEdge);
+                // greedy construction of the chains
+                int pos = 0;
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    if (_tri[t].removed != 2) continue;
+                    _tri[t].removed = 0;
+                    _Corner A = _tri[t].c[0], B = _tri[t].c[1], C = _tri[t].c[2];
+                    const int start = pos++;
+                    pos = _writeElem(pos, A, false);
+                    pos = _writeElem(pos, B, false);
+                    pos = _writeElem(pos, C, false);
+                    int len = 1;
+                    while (len < 32767)
+                        {
+                        _Corner D;
+                        if (_findNext(de, nbe, A, C, D))
+                            { // next triangle is [A, C, D]
+                            pos = _writeElem(pos, D, false);
+                            B = C; C = D;
+                            }
+                        else if (_findNext(de, nbe, C, B, D))
+                            { // next triangle is [C, B, D]
+                            pos = _writeElem(pos, D, true);
+                            A = C; C = D;
+                            }
+                        else break;
+                        len++;
+                        }
+                    _out_face[start] = (uint16_t)len;
+                    }
+                _out_face[pos++] = 0; // end tag
+                _out_len = pos;
+                free(de);
+                return true;
+                }
+
+
+            /** number of vertices used by the encoded mesh. */
+            int outNbVertices() const { return _out_nbv; }
+
+
+            /** length of the encoded face array. */
+            int outLenFace() const { return _out_len; }
+
+
+            /** copy the vertex array of the encoded mesh (in the source mesh coordinates). */
+            void copyVertices(fVec3* dst) const
+                {
+                const float is = 1.0f / _scale;
+                for (int i = 0; i < _nbv; i++)
+                    {
+                    if (_remap[i] >= 0) dst[_remap[i]] = (_moved[i]) ? ((_pos[i] * is) + _center) : _vert[i];
+                    }
+                }
+
+
+            /** copy the face array of the encoded mesh. */
+            void copyFaces(uint16_t* dst) const
+                {
+                memcpy(dst, _out_face, sizeof(uint16_t) * _out_len);
+                }
+
+
+        private:
+
+            struct _Corner { uint16_t v, t, n; };                   // corner of a triangle: vertex, texcoord and normal indices
+            struct _Tri { _Corner c[3]; int removed; };             // triangle
+            struct _Edge { float cost; int32_t tri; int32_t e; };   // edge (tri.c[e], tri.c[e+1]) with its collapse cost
+            struct _DEdge { uint64_t ka, kb; int32_t tri; int32_t e; };   // directed edge between two corners
+
+            int _elemSize() const { return 1 + (_has_tex ? 1 : 0) + (_has_norm ? 1 : 0); }
+
+            uint64_t _key(const _Corner& c) const { return ((uint64_t)c.v) | (((uint64_t)c.t) << 16) | (((uint64_t)c.n) << 32); }
+
+
+            const uint16_t* _readElem(const uint16_t* f, _Corner& c) const
+                {
+                c.v = (*(f++)) & 32767;
+                c.t = (_has_tex) ? *(f++) : 0;
+                c.n = (_has_norm) ? *(f++) : 0;
+                return f;
+                }
+
+
+            int _writeElem(int pos, const _Corner& c, bool dbit)
+                {
+                _out_face[pos++] = (uint16_t)(_remap[c.v] | (dbit ? 32768 : 0));
+                if (_has_tex) _out_face[pos++] = c.t;
+                if (_has_norm) _out_face[pos++] = c.n;
+                return pos;
+                }
+
+
+            void _setTri(int k, const _Corner& c0, const _Corner& c1, const _Corner& c2)
+                {
+                _tri[k].c[0] = c0; _tri[k].c[1] = c1; _tri[k].c[2] = c2;
+                _tri[k].removed = ((c0.v == c1.v) || (c1.v == c2.v) || (c2.v == c0.v)) ? 1 : 0;
+                }
+
+
+            /** find a non encoded triangle with directed edge a->b. Set c to its third corner. */
+            bool _findNext(_DEdge* de, int nbe, const _Corner& a, const _Corner& b, _Corner& c)
+                {
+                const uint64_t ka = _key(a), kb = _key(b);
+                int lo = 0, hi = nbe;
+                while (lo < hi)
+                    {
+                    const int mid = (lo + hi) >> 1;
+                    if ((de[mid].ka < ka) || ((de[mid].ka == ka) && (de[mid].kb < kb))) lo = mid + 1; else hi = mid;
+                    }
+                for (; (lo < nbe) && (de[lo].ka == ka) && (de[lo].kb == kb); lo++)
+                    {
+                    _Tri& T = _tri[de[lo].tri];
+                    if (T.removed != 2) continue;
+                    T.removed = 0;
+                    c = T.c[(de[lo].e + 2) % 3];
+                    return true;
+                    }
+                return false;
+                }
+
+
+            /** add the plane ax + by + cz + d = 0 with weight w to the quadric of vertex v. */
+            void _addPlane(int v, float a, float b, float c, float d, float w)
+                {
+                float* q = _q + 10 * v;
+                q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+                q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+                q[7] += w * c * c; q[8] += w * c * d;
+                q[9] += w * d * d;
+                }
+
+
+            /** compute the quadric of each vertex from the planes of its adjacent triangles (plus border/seam constraints). */
+            void _computeQuadrics()
+                {
+                memset(_q, 0, sizeof(float) * 10 * _nbv);
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    if (_tri[t].removed) continue;
+                    const fVec3& P0 = _pos[_tri[t].c[0].v];
+                    fVec3 N = crossProduct(_pos[_tri[t].c[1].v] - P0, _pos[_tri[t].c[2].v] - P0);
+                    const float l = N.norm();
+                    if (l <= 0) continue;
+                    N /= l;
+                    const float d = -dotProduct(N, P0);
+                    for (int k = 0; k < 3; k++) _addPlane(_tri[t].c[k].v, N.x, N.y, N.z, d, l * 0.5f);
+                    }
+                // find the border and seam edges: edges with a single adjacent triangle or
+                // whose two adjacent triangles do not share the same texture coordinates.
+                _DEdge* de = (_DEdge*)malloc(sizeof(_DEdge) * 3 * _nbt);
+                if (!de) return; // not critical, just skip border preservation
+                int nbe = 0;
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    if (_tri[t].removed) continue;
+                    for (int e = 0; e < 3; e++)
+                        {
+                        _Corner a = _tri[t].c[e], b = _tri[t].c[(e + 1) % 3];
+                        if (a.v > b.v) { _Corner c = a; a = b; b = c; }
+                        a.n = 0; b.n = 0; // normals may differ along creases: only compare positions and texture coords.
+                        de[nbe].ka = (((uint64_t)a.v) << 16) | b.v;
+                        de[nbe].kb = (((uint64_t)a.t) << 16) | b.t;
+                        de[nbe].tri = t;
+                        de[nbe].e = e;
+                        nbe++;
+                        }
+                    }
+                qsort(de, nbe, sizeof(_DEdge), _cmpDEdge);
+                int i = 0;
+                while (i < nbe)
+                    {
+                    int j = i + 1;
+                    while ((j < nbe) && (de[j].ka == de[i].ka)) j++;
+                    const bool border = ((j - i) != 2) || (de[i].kb != de[i + 1].kb);
+                    if (border)
+                        {
+                        for (int k = i; k < j; k++)
+                            {
+                            const _Tri& T = _tri[de[k].tri];
+                            const int a = T.c[de[k].e].v;
+                            const int b = T.c[(de[k].e + 1) % 3].v;
+                            const fVec3 E = _pos[b] - _pos[a];
+                            const fVec3 N = crossProduct(_pos[T.c[1].v] - _pos[T.c[0].v], _pos[T.c[2].v] - _pos[T.c[0].v]);
+                            fVec3 P = crossProduct(E, N); // plane containing the edge and orthogonal to the triangle
+                            const float l = P.norm();
+                            if (l <= 0) continue;
+                            P /= l;
+                            const float d = -dotProduct(P, _pos[a]);
+                            const float w = 100.0f * E.norm2();
+                            _addPlane(a, P.x, P.y, P.z, d, w);
+                            _addPlane(b, P.x, P.y, P.z, d, w);
+                            }
+                        }
+                    i = j;
+                    }
+                free(de);
+                }
+
+
+            /** evaluate the quadric q + r at position p. */
+            static float _eval(const float* q, const float* r, const fVec3& p)
+                {
+                float Q[10];
+                for (int k = 0; k < 10; k++) Q[k] = q[k] + r[k];
+                return (Q[0] * p.x * p.x) + (2 * Q[1] * p.x * p.y) + (2 * Q[2] * p.x * p.z) + (2 * Q[3] * p.x)
+                     + (Q[4] * p.y * p.y) + (2 * Q[5] * p.y * p.z) + (2 * Q[6] * p.y)
+                     + (Q[7] * p.z * p.z) + (2 * Q[8] * p.z)
+                     + Q[9];
+                }
+
+
+            /** cost of collapsing edge (a,b). The new position (among the endpoints and the midpoint) is put in p. */
+            float _collapseCost(int a, int b, fVec3& p) const
+                {
+                const float* qa = _q + 10 * a;
+                const float* qb = _q + 10 * b;
+                const fVec3 M = (_pos[a] + _pos[b]) * 0.5f;
+                float c = _eval(qa, qb, M);
+                p = M;
+                const float ca = _eval(qa, qb, _pos[a]);
+                if (ca < c) { c = ca; p = _pos[a]; }
+                const float cb = _eval(qa, qb, _pos[b]);
+                if (cb < c) { c = cb; p = _pos[b]; }
+                return c;
+                }
+
+
+            /** return true if moving vertex u to p (when collapsing edge (u,w)) flips or degenerates an adjacent triangle. */
+            bool _flips(int u, int w, const fVec3& p) const
+                {
+                for (int i = _adj_start[u]; i < _adj_start[u + 1]; i++)
+                    {
+                    const _Tri& T = _tri[_adj[i]];
+                    if (T.removed) continue;
+                    int k;
+                    for (k = 0; k < 3; k++) { if (T.c[k].v == u) break; }
+                    if (k == 3) continue;
+                    const int j = T.c[(k + 1) % 3].v;
+                    const int l = T.c[(k + 2) % 3].v;
+                    if ((j == w) || (l == w)) continue; // this triangle is removed by the collapse
+                    const fVec3 N0 = crossProduct(_pos[j] - _pos[u], _pos[l] - _pos[u]);
+                    const fVec3 N1 = crossProduct(_pos[j] - p, _pos[l] - p);
+                    const float d = dotProduct(N0, N1);
+                    if ((d <= 0) || (d * d < 0.04f * N0.norm2() * N1.norm2())) return true;
+                    }
+                return false;
+                }
+
+
+            /** collapse vertex b onto vertex a (moved to p). */
+            void _collapse(int a, int b, const fVec3& p)
+                {
+                if ((p.x != _pos[a].x) || (p.y != _pos[a].y) || (p.z != _pos[a].z)) _moved[a] = 1;
+                _pos[a] = p;
+                for (int k = 0; k < 10; k++) _q[10 * a + k] += _q[10 * b + k];
+                // remove the triangles containing the edge and record, for each of them, the
+                // attributes of corner a that replace those of corner b.
+                const int MAXMAP = 4;
+                _Corner from[MAXMAP], to[MAXMAP];
+                int nbmap = 0;
+                for (int i = _adj_start[b]; i < _adj_start[b + 1]; i++)
+                    {
+                    _Tri& T = _tri[_adj[i]];
+                    if (T.removed) continue;
+                    int ka = -1, kb = -1;
+                    for (int k = 0; k < 3; k++) { if (T.c[k].v == a) ka = k; if (T.c[k].v == b) kb = k; }
+                    if (ka < 0) continue;
+                    if (nbmap < MAXMAP) { from[nbmap] = T.c[kb]; to[nbmap] = T.c[ka]; nbmap++; }
+                    T.removed = 1;
+                    _alive--;
+                    }
+                // move the other triangles from b to a
+                for (int i = _adj_start[b]; i < _adj_start[b + 1]; i++)
+                    {
+                    _Tri& T = _tri[_adj[i]];
+                    if (T.removed) continue;
+                    for (int k = 0; k < 3; k++)
+                        {
+                        if (T.c[k].v != b) continue;
+                        T.c[k].v = (uint16_t)a;
+                        for (int m = 0; m < nbmap; m++)
+                            {
+                            if ((from[m].t == T.c[k].t) && (from[m].n == T.c[k].n)) { T.c[k].t = to[m].t; T.c[k].n = to[m].n; break; }
+                            }
+                        }
+                    }
+                _flag[a] = 1;
+                _flag[b] = 1;
+                }
+
+
+            /** build the vertex -> triangles adjacency lists. */
+            void _buildAdjacency()
+                {
+                memset(_adj_start, 0, sizeof(int32_t) * (_nbv + 1));
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    if (_tri[t].removed) continue;
+                    for (int k = 0; k < 3; k++) _adj_start[_tri[t].c[k].v + 1]++;
+                    }
+                for (int i = 0; i < _nbv; i++) _adj_start[i + 1] += _adj_start[i];
+                for (int t = 0; t < _nbt; t++)
+                    {
+                    if (_tri[t].removed) continue;
+                    for (int k = 0; k < 3; k++) _adj[_adj_start[_tri[t].c[k].v]++] = t;
+                    }
+                for (int i = _nbv; i > 0; i--) _adj_start[i] = _adj_start[i - 1];
+                _adj_start[0] = 0;
+                }
+
+
+            static int _cmpEdge(const void* A, const void* B)
+                {
+                const float a = ((const _Edge*)A)->cost;
+                const float b = ((const _Edge*)B)->cost;
+                return (a < b) ? -1 : ((a > b) ? 1 : 0);
+                }
+
+
+            static int _cmpDEdge(const void* A, const void* B)
+                {
+                const _DEdge* a = (const _DEdge*)A;
+                const _DEdge* b = (const _DEdge*)B;
+                if (a->ka != b->ka) return (a->ka < b->ka) ? -1 : 1;
+                if (a->kb != b->kb) return (a->kb < b->kb) ? -1 : 1;
+                return 0;
+                }
+
+
+            int         _nbv;           // number of vertices
+            int         _nbt;           // number of triangles (including removed ones)
+            int         _alive;         // number of remaining triangles
+            bool        _has_tex;       // true if the face array contains texture indices
+            bool        _has_norm;      // true if the face array contains normal indices
+            const fVec3* _vert;         // source vertex array
+            fVec3*      _pos;           // vertex positions (normalized)
+            float*      _q;             // vertex quadrics (10 floats per vertex)
+            uint8_t*    _flag;          // vertices modified during the current pass
+            uint8_t*    _moved;         // vertices whose position differs from the source mesh
+            _Tri*       _tri;           // triangles
+            int32_t*    _adj_start;     // start of the adjacency list of each vertex in _adj
+            int32_t*    _adj;           // vertex -> triangles adjacency lists
+            int32_t*    _remap;         // new index of each vertex in the simplified mesh (or -1)
+            int         _out_nbv;       // number of vertices in the simplified mesh
+            uint16_t*   _out_face;      // encoded face array
+            int         _out_len;       // length of the encoded face array
+            fVec3       _center;        // normalization: pos = (vertex - center) * scale
+            float       _scale;
+        };
+
+
+
+    template<typename color_t> Mesh3D<color_t>* simplifyMesh(const Mesh3D<color_t>* mesh, int target_faces)
+        {
+        if ((mesh == nullptr) || (mesh->vertice == nullptr) || (mesh->face == nullptr)) return nullptr;
+        _MeshSimplifier S;
+        if (!S.load(mesh->vertice, mesh->nb_vertices, mesh->face, (mesh->texcoord != nullptr), (mesh->normal != nullptr))) return nullptr;
+        if (!S.simplify(target_faces)) return nullptr;
+        if (!S.encode()) return nullptr;
+        if (S.outLenFace() > 65535) return nullptr; // too long to fit in Mesh3D::len_face
+
+        // allocate the mesh, its vertex array and its face array in a single block.
+        const size_t off_v = (sizeof(Mesh3D<color_t>) + 7) & ~((size_t)7);
+        const size_t off_f = off_v + sizeof(fVec3) * S.outNbVertices();
+        char* mem = (char*)malloc(off_f + sizeof(uint16_t) * S.outLenFace());
+        if (mem == nullptr) return nullptr;
+        Mesh3D<color_t>* res = (Mesh3D<color_t>*)mem;
+        memcpy(res, mesh, sizeof(Mesh3D<color_t>));
+        fVec3* vert = (fVec3*)(mem + off_v);
+        uint16_t* face = (uint16_t*)(mem + off_f);
+        S.copyVertices(vert);
+        S.copyFaces(face);
+        res->nb_vertices = (uint16_t)S.outNbVertices();
+        res->nb_faces = (uint16_t)S.nbFaces();
+        res->len_face = (uint16_t)S.outLenFace();
+        res->vertice = vert;
+        res->face = face;
+        res->next = nullptr;
+        res->lod = nullptr;
+        res->compact = nullptr; // the compact attributes refer to the vertices of the source mesh
+        res->nb_clusters = 0; // the clusters refer to the face array of the source mesh
+        res->cluster = nullptr;
+        return res;
+        }
+
+
+
+    template<typename color_t> Mesh3D<color_t>* createMeshLOD(const Mesh3D<color_t>* mesh, int nb_levels, float ratio, int min_faces)
+        {
+        for (const Mesh3D<color_t>* m = mesh; m != nullptr; m = m->next)
+            {
+            if ((m->vertice == nullptr) || (m->face == nullptr)) return nullptr; // cannot be simplified
+            }
+        Mesh3D<color_t>* head = nullptr;
+        Mesh3D<color_t>* prev = nullptr;
+        while (mesh)
+            {
+            Mesh3D<color_t>* cur = (Mesh3D<color_t>*)malloc(sizeof(Mesh3D<color_t>));
+            if (cur == nullptr) { freeMeshLOD(head); return nullptr; }
+            memcpy(cur, mesh, sizeof(Mesh3D<color_t>));
+            cur->next = nullptr;
+            cur->lod = nullptr;
+            if (prev) prev->next = cur; else head = cur;
+            prev = cur;
+            // create the levels of detail
+            Mesh3D<color_t>* level = cur;
+            for (int l = 0; l < nb_levels; l++)
+                {
+                const int target = (int)(level->nb_faces * ratio);
+                if (target < min_faces) break;
+                Mesh3D<color_t>* sub = simplifyMesh(level, target);
+                if (sub == nullptr) { freeMeshLOD(head); return nullptr; }
+                if (sub->nb_faces >= level->nb_faces * (1.0f + ratio) * 0.5f)
+                    { // simplification is stuck: no need to go further
+                    free(sub);
+                    break;
+                    }
+                level->lod = sub;
+                level = sub;
+                }
+            mesh = mesh->next;
+            }
+        return head;
+        }
+
+
+
+    template<typename color_t> void freeMeshLOD(Mesh3D<color_t>* mesh)
+        {
+        while (mesh)
+            {
+            Mesh3D<color_t>* level = (Mesh3D<color_t>*)mesh->lod;
+            while (level)
+                {
+                Mesh3D<color_t>* l = level;
+                level = (Mesh3D<color_t>*)level->lod;
+                free(l);
+                }
+            Mesh3D<color_t>* m = mesh;
+            mesh = (Mesh3D<color_t>*)mesh->next;
+            free(m);
+            }
+        }
+
+
+}
+
+
+#endif
+
+#endif
+
+
+/** end of file */
+
@@ -0,0 +1,129 @@
+/** @file Mipmap.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+#ifndef _TGX_MIPMAP_H_
+#define _TGX_MIPMAP_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Color.h"
+#include "Image.h"
+
+#include <stdint.h>
+
+
+#define TGX_MIPMAP_MAX_LEVELS (12) // <- max number of levels in a mip chain (enough for 2048x2048 textures)
+
+
+namespace tgx
+{
+
+
+    /**
+    * Mip chain of a texture.
+    *
+    * level[0] is the texture itself and level[k+1] is level[k] reduced by half (with
+    * Image::copyReduceHalf()) until a 1x1 image is reached. When a mesh has a mip chain
+    * (Mesh3D::mipmap), the renderer selects, for each triangle, the level whose texel
+    * density best matches the size of the triangle on the screen. Distant objects thus
+    * read their texture from a much smaller (and cache friendly) image and do not alias.
+    *
+    * The reduced levels are stored in a user supplied buffer (the texture itself is not
+    * copied). Since the texture shaders wrap texture coordinates with a mask, the texture
+    * dimensions must be powers of two (as for regular texturing).
+    *
+    * Example:
+    *
+    *     static RGB565 mipbuf[Mipmap<RGB565>::bufferSize(256, 256)];
+    *     Mipmap<RGB565> mip;
+    *     mip.build(texture, mipbuf, sizeof(mipbuf) / sizeof(RGB565));
+    **/
+    template<typename color_t> struct Mipmap
+        {
+        // make sure right away that the template parameter is admissible to prevent cryptic error message later.
+        static_assert(is_color<color_t>::value, "color_t must be one of the color types defined in color.h");
+
+        int nb_levels;                                  // number of levels in the chain (0 if not built)
+        Image<color_t> level[TGX_MIPMAP_MAX_LEVELS];    // the levels: level[0] is the full resolution texture.
+
+
+        /** Construct an empty mip chain. */
+        Mipmap() : nb_levels(0)
+            {
+            }
+
+
+        /**
+        * Return the size of the buffer (in number of color_t) needed to store the reduced
+        * levels of a texture with size lx x ly (about a third of the texture size).
+        **/
+        static constexpr int bufferSize(int lx, int ly)
+            {
+            return ((lx <= 1) && (ly <= 1)) ? 0 : (((lx > 1) ? (lx >> 1) : 1) * ((ly > 1) ? (ly >> 1) : 1) + bufferSize((lx > 1) ? (lx >> 1) : 1, (ly > 1) ? (ly >> 1) : 1));
+            }
+
+
+        /**
+        * Build the mip chain of a texture.
+        *
+        * - texture    : the full resolution texture (it is not copied and must remain valid).
+        * - buffer     : memory where the reduced levels are stored.
+        * - buffer_len : size of the buffer in number of color_t. Use bufferSize() to find the size
+        *                needed for the complete chain. If the buffer is smaller, the chain is
+        *                truncated to the levels that fit in it.
+        * - max_levels : maximum number of levels (including the texture itself).
+        *
+        * Return the number of levels in the chain (0 if the texture is invalid).
+        **/
+        int build(const Image<color_t>& texture, color_t* buffer, int buffer_len, int max_levels = TGX_MIPMAP_MAX_LEVELS)
+            {
+            nb_levels = 0;
+            if (!texture.isValid()) return 0;
+            max_levels = clamp(max_levels, 1, TGX_MIPMAP_MAX_LEVELS);
+            level[0] = texture;
+            nb_levels = 1;
+            while ((nb_levels < max_levels) && ((level[nb_levels - 1].lx() > 1) || (level[nb_levels - 1].ly() > 1)))
+                {
+                const Image<color_t>& src = level[nb_levels - 1];
+                const int lx = (src.lx() > 1) ? (src.lx() >> 1) : 1;
+                const int ly = (src.ly() > 1) ? (src.ly() >> 1) : 1;
+                if ((buffer == nullptr) || (buffer_len < lx * ly)) break; // no more room
+                Image<color_t> dst(buffer, lx, ly);
+                level[nb_levels] = dst.copyReduceHalf(src);
+                if (!level[nb_levels].isValid()) break;
+                buffer += lx * ly;
+                buffer_len -= lx * ly;
+                nb_levels++;
+                }
+            return nb_levels;
+            }
+
+        };
+
+
+}
+
+
+#endif
+
+#endif
+
+
+/** end of file */
+
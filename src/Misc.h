@@ -42,6 +42,61 @@
 #endif
 
 
+/* Set this to 1 to use SIMD instructions (SSE2 on x86, NEON on ARM) in the shaders 
+   inner loops and set it to 0 to use plain C++ code. Enabled by default when available. */
+#ifndef TGX_USE_SIMD
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define TGX_USE_SIMD 1
+    #else
+        #define TGX_USE_SIMD 0
+    #endif
+#endif
+
+
+/* Set this to 1 to rasterize large triangles by 8x8 blocks classified against the triangle 
+   edges (and the hierarchical zbuffer when used) and set it to 0 to draw them with a single call 
+   to the span shaders. Runs of fully covered blocks are filled by the flat shaders without any
+   edge test (about 3x faster for fullscreen flat triangles on desktop) but the other shaders only
+   pay for the extra calls. Disabled by default for this reason. */
+#ifndef TGX_RASTERIZE_BLOCKS
+    #define TGX_RASTERIZE_BLOCKS 0
+#endif
+
+
+/* Set this to 1 to enable multi-threaded rasterization (requires std::thread) 
+   and set it to 0 to disable it. Enabled by default only when compiling for a 
+   hosted OS (Linux, Windows, macOS): MCU toolchains usually lack std::thread. */
+#ifndef TGX_MULTITHREAD
+    #if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
+        #define TGX_MULTITHREAD 1
+    #else
+        #define TGX_MULTITHREAD 0
+    #endif
+#endif
+
+
+/* Set this to 1 to let Renderer3D count the triangles culled/clipped/rasterized and the pixels
+   depth tested (see Renderer3D::getStats()) and set it to 0 to compile the counters out.
+   Disabled by default. */
+#ifndef TGX_RENDERER_STATS
+    #define TGX_RENDERER_STATS 0
+#endif
+
+#if TGX_RENDERER_STATS
+    #define TGX_STAT(expr) { expr; }
+#else
+    #define TGX_STAT(expr)
+#endif
+
+
+/* Set this to 1 to record the time spent in the main stages of the library (mesh setup, culling,
+   vertex transform, triangle setup, shader spans, blitting, text) and export it as a Chrome trace
+   (see Trace.h). Requires std::chrono, std::mutex and stdio. Disabled by default. */
+#ifndef TGX_TRACE
+    #define TGX_TRACE 0
+#endif
+
+
 
 // c++, no plain c
 #ifdef __cplusplus
@@ -23,6 +23,7 @@
 
 
 #include "ShaderParams.h"
+#include "Trace.h"
 
 namespace tgx
 {
@@ -37,6 +38,11 @@ namespace tgx
 	*
 	* - Tile rasterization: large viewport can be splitted in multiple sub-images.
 	*
+	* - Large triangles can be rasterized by 8x8 blocks with trivial accept/reject (TGX_RASTERIZE_BLOCKS).
+	*
+	* - Fast path for small triangles (32 bit edge setup, covered pixels of micro triangles found
+	*   before calling the shader).
+	*
 	* - Zbuffer depth testing
 	*
 	* - Perspective/Orthographic projection rasterization.
@@ -85,6 +91,10 @@ namespace tgx
 	*                parameters associated with each vertex, namely the  texture coords.
 	*                and the color associated with each vertex (when applicable).
 	*
+	*                The vertex type is a template parameter: any type deriving from fVec4 may
+	*                be used as long as the shader accepts it. The built-in shaders use
+	*                RasterizerVec4 and ShaderFunctor uses RasterizerVertex<VARYINGS>.
+	*
 	*			     NOTE: the (x,y) coordinates of the vertices V0,V1,V2 do not need to
 	*                be inside the viewport [-1.0,1.0]^2 and the triangle will still be
 	*                perfectly rasterized provided that they are not 'too far away'. This
@@ -102,13 +112,165 @@ namespace tgx
 	*                       is drawn onto the image.
 	*
 	* - data : contain the 'uniform' parameters depending on the rasterization type.
+	*          If data.hiz is not nullptr, it must point to the hierarchical zbuffer that holds
+	*          the minimum depth of each 8x8 block of the image (negative value = dirty block
+	*          to be recomputed from data.zbuf). Triangles and rows of blocks that are completely
+	*          hidden are then discarded before calling the shader. The blocks drawn onto are
+	*          marked as dirty only if a pixel passed the depth test (see depthTest()).
 	*
 	* REMARKS: color are passed in RGBf format irrespectively of the image color type to improve
 	*          quality and simplify handling of different image types.
 	**/
 	
-	template<int LX, int LY, typename SHADER_FUNCTION, typename RASTERIZER_PARAMS> 
-	void rasterizeTriangle(const RasterizerVec4 & V0, const RasterizerVec4 & V1, const RasterizerVec4 & V2, const int32_t offset_x, const int32_t offset_y, const RASTERIZER_PARAMS & data, SHADER_FUNCTION shader_fun)
+	/**
+	* Return the minimum value of the zbuffer on the 8x8 block (bx, by) of the image (i.e. the depth
+	* of the farthest pixel of the block). The value is taken from the hierarchical zbuffer data.hiz
+	* and recomputed from the zbuffer if the block is marked as dirty (negative value).
+	**/
+	template<typename RASTERIZER_PARAMS>
+	TGX_INLINE float hizBlockMin(const int32_t bx, const int32_t by, const RASTERIZER_PARAMS & data)
+		{
+		float & H = data.hiz[bx + (by * data.hiz_stride)];
+		if (H < 0)
+			{ // dirty block: recompute its min. depth 
+			const int32_t zstride = data.im->stride();
+			const int32_t x0 = bx << 3;
+			const int32_t y0 = by << 3;
+			const int32_t x1 = min(x0 + 8, data.im->lx());
+			const int32_t y1 = min(y0 + 8, data.im->ly());
+			float m = zbufferDepth(data.zbuf[x0 + (y0 * zstride)], data.zepoch);
+			for (int32_t j = y0; j < y1; j++)
+				{
+				const auto* zb = data.zbuf + (j * zstride);
+				for (int32_t i = x0; i < x1; i++) { const float d = zbufferDepth(zb[i], data.zepoch); if (d < m) m = d; }
+				}
+			H = m;
+			}
+		return H;
+		}
+
+
+
+	/**
+	* Return the value (in pixel units) of the edge function of the edge starting at P with
+	* direction (dx, dy) at the subpixel position (us, vs), taking the top-left rule into
+	* account. INT_t is the integer type used for the computation: int64_t in general or
+	* int32_t when the triangle is small enough for the products not to overflow.
+	**/
+	template<typename INT_t, int SUBPIXEL_BITS>
+	TGX_INLINE int32_t rasterizeEdgeOffset(const int32_t us, const int32_t vs, const iVec2 & P, const int32_t dx, const int32_t dy)
+		{
+		INT_t dO = (((INT_t)(us - P.x)) * ((INT_t)dx)) + (((INT_t)(vs - P.y)) * ((INT_t)dy));
+		if ((dx < 0) || ((dx == 0) && (dy < 0))) dO--; // top left rule (beware, changes total aera).
+		return (dO >= 0) ? ((int32_t)(dO >> SUBPIXEL_BITS)) : -((int32_t)((-dO + ((((INT_t)1) << SUBPIXEL_BITS) - 1)) >> SUBPIXEL_BITS));
+		}
+
+
+
+	/**
+	* Call the shader on the rectangle [ox, ox + sx[x[oy, oy + sy[ of the image where (O1, O2, O3)
+	* are the values of the edge functions at (ox, oy) (same parameters as the shader).
+	*
+	* When TGX_RASTERIZE_BLOCKS is set, large rectangles are split in 8x8 blocks (aligned with
+	* the blocks of the hierarchical zbuffer) which are classified against the three edge functions:
+	*
+	* - blocks completely outside the triangle are skipped. So are the blocks that are hidden
+	*   according to the hierarchical zbuffer (if data.hiz is set) where wmax is the depth of
+	*   the closest point of the triangle.
+	*
+	* - each run of fully covered blocks is passed to the shader in its own call: the whole
+	*   rectangle is then inside the triangle and the flat shaders fill it with the edge test
+	*   free span kernels (see rectInsideTriangle()). Other shaders simply never find a pixel
+	*   outside the triangle.
+	*
+	* - runs of partially covered blocks use the usual per pixel path.
+	**/
+	template<typename SHADER_FUNCTION, typename RASTERIZER_PARAMS, typename VERTEX_t>
+	TGX_INLINE void rasterizeRect(const int32_t ox, const int32_t oy, const int32_t sx, const int32_t sy,
+		const int32_t dx1, const int32_t dy1, const int32_t O1, const VERTEX_t & fP1,
+		const int32_t dx2, const int32_t dy2, const int32_t O2, const VERTEX_t & fP2,
+		const int32_t dx3, const int32_t dy3, const int32_t O3, const VERTEX_t & fP3,
+		const float wmax, const RASTERIZER_PARAMS & data, SHADER_FUNCTION shader_fun)
+		{
+		const int32_t BLOCK_MIN_SX = 64; // <- use blocks only for rectangles at least this wide
+		const int32_t BLOCK_MIN_SY = 64; // <- and at least this high
+		TGX_TRACE_SCOPE("shader spans");
+		const int32_t stride = data.im->stride();
+		if ((!TGX_RASTERIZE_BLOCKS) || (sx < BLOCK_MIN_SX) || (sy < BLOCK_MIN_SY))
+			{
+			shader_fun(ox + (stride * oy), sx, sy, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+			return;
+			}
+		const int32_t x1 = ox + sx;
+		const int32_t y1 = oy + sy;
+		const int32_t bx0 = (ox & ~7);
+		// offsets from the top left corner of a block to the min/max of the edge functions on the block
+		// (the blocks cut by the rectangle are classified as if they were complete, which is conservative).
+		const int32_t lx1 = min(0, 7 * dx1), lx2 = min(0, 7 * dx2), lx3 = min(0, 7 * dx3);
+		const int32_t hx1 = max(0, 7 * dx1), hx2 = max(0, 7 * dx2), hx3 = max(0, 7 * dx3);
+		const int32_t lo1 = lx1 + min(0, 7 * dy1), lo2 = lx2 + min(0, 7 * dy2), lo3 = lx3 + min(0, 7 * dy3);
+		const int32_t hi1 = hx1 + max(0, 7 * dy1), hi2 = hx2 + max(0, 7 * dy2), hi3 = hx3 + max(0, 7 * dy3);
+		for (int32_t by = (oy & ~7); by < y1; by += 8)
+			{
+			const int32_t j0 = max(by, oy);
+			const int32_t h = min(by + 8, y1) - j0;
+			// value of the edge functions at the start of the row of blocks (at the first pixel of the rectangle
+			// and at the top left corner of the first block).
+			const int32_t R1 = O1 + ((j0 - oy) * dy1);
+			const int32_t R2 = O2 + ((j0 - oy) * dy2);
+			const int32_t R3 = O3 + ((j0 - oy) * dy3);
+			int32_t E1 = O1 + ((bx0 - ox) * dx1) + ((by - oy) * dy1);
+			int32_t E2 = O2 + ((bx0 - ox) * dx2) + ((by - oy) * dy2);
+			int32_t E3 = O3 + ((bx0 - ox) * dx3) + ((by - oy) * dy3);
+			int32_t run = 0;		// class of the first block of the current run (0 = no run, 1 = partially covered, 2 = fully covered)
+			int32_t run_x = ox;		// start of the current run
+			bool seen = false;		// true once a block intersecting the triangle has been found on this row of blocks
+			for (int32_t bx = bx0; ; bx += 8)
+				{
+				const int32_t i0 = max(bx, ox);
+				int32_t cl = -1; // -1 = end of the row of blocks
+				if (bx < x1)
+					{
+					cl = 0;
+					if (((E1 + hi1) | (E2 + hi2) | (E3 + hi3)) >= 0)
+						{
+						seen = true;
+						if ((data.hiz == nullptr) || (hizBlockMin(bx >> 3, by >> 3, data) < wmax))
+							{
+							cl = (((E1 + lo1) | (E2 + lo2) | (E3 + lo3)) >= 0) ? 2 : 1;
+							}
+						}
+					else if (seen)
+						{
+						cl = -1; // the triangle is convex: the remaining blocks on this row are outside.
+						}
+					}
+				if (cl != run)
+					{ // end the current run (if any) when the class of the blocks changes.
+					if (run > 0)
+						{
+						const int32_t u = run_x - ox;
+						shader_fun(run_x + (stride * j0), i0 - run_x, h,
+							dx1, dy1, R1 + (u * dx1), fP1,
+							dx2, dy2, R2 + (u * dx2), fP2,
+							dx3, dy3, R3 + (u * dx3), fP3,
+							data);
+						}
+					run = (cl > 0) ? cl : 0;
+					run_x = i0;
+					}
+				if (cl < 0) break;
+				E1 += (dx1 << 3);
+				E2 += (dx2 << 3);
+				E3 += (dx3 << 3);
+				}
+			}
+		}
+
+
+
+	template<int LX, int LY, typename SHADER_FUNCTION, typename RASTERIZER_PARAMS, typename VERTEX_t> 
+	void rasterizeTriangle(const VERTEX_t & V0, const VERTEX_t & V1, const VERTEX_t & V2, const int32_t offset_x, const int32_t offset_y, const RASTERIZER_PARAMS & data, SHADER_FUNCTION shader_fun)
 		{
 		#define TGX_RASTERIZE_SUBPIXEL_BITS (8) // <- change this to adjust sub-pixel precision (between 1 and 8)
 		#define TGX_RASTERIZE_SUBPIXEL256 (1 << TGX_RASTERIZE_SUBPIXEL_BITS)
@@ -116,6 +278,11 @@ namespace tgx
 		#define TGX_RASTERIZE_MULT256(X) ((X) << (TGX_RASTERIZE_SUBPIXEL_BITS))
 		#define TGX_RASTERIZE_MULT128(X) ((X) << (TGX_RASTERIZE_SUBPIXEL_BITS -1))
 		#define TGX_RASTERIZE_DIV256(X) ((X) >> (TGX_RASTERIZE_SUBPIXEL_BITS))
+		#define TGX_RASTERIZE_HIZ_MIN_AERA (64) // <- bounding box aera (in pixels) under which the hierarchical zbuffer test is skipped
+		#define TGX_RASTERIZE_SMALL_SIZE (64) // <- triangles whose bounding box is at most this size (in pixels) in both directions use 32 bit edge setup
+		#define TGX_RASTERIZE_MICRO_AERA (16) // <- bounding box aera (in pixels) under which the covered pixels are found before calling the shader
+
+		TGX_TRACE_SCOPE("rasterizeTriangle"); // the setup is the self time of this event (the shader calls are nested in it)
 
 		// assuming that clipping was already perfomed and that V0, V1, V2 are in a reasonable "range" so no overflow will occur. 
 		const float mx = (float)(TGX_RASTERIZE_MULT128(LX));
@@ -142,12 +309,55 @@ namespace tgx
 		if (oy + sy > ymax) { sy = ymax - oy + 1; }
 		if (sy <= 0) return;
 
-		const int64_t a = (((int64_t)(sP2.x - P0.x)) * ((int64_t)(sP1.y - P0.y))) - (((int64_t)(sP2.y - P0.y)) * ((int64_t)(sP1.x - P0.x))); // aera
+		// hierarchical zbuffer: discard the triangle (or the rows of blocks) hidden behind what is already drawn.
+		float wmax = 0; // depth of the closest point of the triangle (when using the hierarchical zbuffer).
+		if (data.hiz)
+			{
+			wmax = (max(max(V0.w, V1.w), V2.w) + data.zoff) * data.zmul;
+			if (sx * sy >= TGX_RASTERIZE_HIZ_MIN_AERA)
+				{ // w is affine in screen space so the triangle is hidden where the zbuffer is everywhere >= max(w).
+				const int32_t hbx0 = (ox - offset_x) >> 3;
+				const int32_t hbx1 = (ox - offset_x + sx - 1) >> 3;
+				const int32_t hby0 = (oy - offset_y) >> 3;
+				const int32_t hby1 = (oy - offset_y + sy - 1) >> 3;
+				int32_t first = hby1 + 1;
+				int32_t last = hby0 - 1;
+				for (int32_t by = hby0; by <= hby1; by++)
+					{
+					for (int32_t bx = hbx0; bx <= hbx1; bx++)
+						{
+						if (hizBlockMin(bx, by, data) < wmax)
+							{
+							if (first > by) first = by;
+							last = by;
+							break;
+							}
+						}
+					}
+				if (first > hby1) return; // whole triangle is hidden
+				if (first > hby0)
+					{
+					const int32_t d = offset_y + (first << 3) - oy;
+					oy += d;
+					sy -= d;
+					}
+				if (last < hby1)
+					{
+					sy = offset_y + ((last + 1) << 3) - oy;
+					}
+				}
+			}
+
+		// small triangles (the vast majority for dense meshes) do not need 64 bit arithmetic for the edge setup.
+		const bool small = ((xmax - xmin) <= TGX_RASTERIZE_SMALL_SIZE) && ((ymax - ymin) <= TGX_RASTERIZE_SMALL_SIZE);
+
+		const int64_t a = (small) ? ((int64_t)(((sP2.x - P0.x) * (sP1.y - P0.y)) - ((sP2.y - P0.y) * (sP1.x - P0.x)))) // aera
+								  : ((((int64_t)(sP2.x - P0.x)) * ((int64_t)(sP1.y - P0.y))) - (((int64_t)(sP2.y - P0.y)) * ((int64_t)(sP1.x - P0.x)))); 
 
 		if (a == 0) return; // do not draw flat triangles
 
-		const RasterizerVec4& fP1 = (a > 0) ? V1 : V2;
-		const RasterizerVec4& fP2 = (a > 0) ? V2 : V1;
+		const VERTEX_t& fP1 = (a > 0) ? V1 : V2;
+		const VERTEX_t& fP2 = (a > 0) ? V2 : V1;
 		const iVec2& P1 = (a > 0) ? sP1 : sP2;
 		const iVec2& P2 = (a > 0) ? sP2 : sP1;
 
@@ -159,23 +369,57 @@ namespace tgx
 
 		const int32_t dx1 = P1.y - P0.y;
 		const int32_t dy1 = P0.x - P1.x;
-		int64_t dO1 = (((int64_t)(us - P0.x)) * ((int64_t)dx1)) + (((int64_t)(vs - P0.y)) * ((int64_t)dy1));
-		if ((dx1 < 0) || ((dx1 == 0) && (dy1 < 0))) dO1--; // top left rule (beware, changes total aera).
-		int32_t O1 = (dO1 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO1)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO1 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
-
 		const int32_t dx2 = P2.y - P1.y;
 		const int32_t dy2 = P1.x - P2.x;
-		int64_t dO2 = (((int64_t)(us - P1.x)) * ((int64_t)dx2)) + (((int64_t)(vs - P1.y)) * ((int64_t)dy2));
-		if ((dx2 < 0) || ((dx2 == 0) && (dy2 < 0))) dO2--; // top left rule (beware, changes total aera).  
-		int32_t O2 = (dO2 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO2)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO2 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
-
 		const int32_t dx3 = P0.y - P2.y;
 		const int32_t dy3 = P2.x - P0.x;
-		int64_t dO3 = (((int64_t)(us - P2.x)) * ((int64_t)dx3)) + (((int64_t)(vs - P2.y)) * ((int64_t)dy3));
-		if ((dx3 < 0) || ((dx3 == 0) && (dy3 < 0))) dO3--; // top left rule (beware, changes total aera).  
-		int32_t O3 = (dO3 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO3)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO3 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
 
-		if (sx == 1)
+		int32_t O1, O2, O3;
+		if (small)
+			{
+			O1 = rasterizeEdgeOffset<int32_t, TGX_RASTERIZE_SUBPIXEL_BITS>(us, vs, P0, dx1, dy1);
+			O2 = rasterizeEdgeOffset<int32_t, TGX_RASTERIZE_SUBPIXEL_BITS>(us, vs, P1, dx2, dy2);
+			O3 = rasterizeEdgeOffset<int32_t, TGX_RASTERIZE_SUBPIXEL_BITS>(us, vs, P2, dx3, dy3);
+			}
+		else
+			{
+			O1 = rasterizeEdgeOffset<int64_t, TGX_RASTERIZE_SUBPIXEL_BITS>(us, vs, P0, dx1, dy1);
+			O2 = rasterizeEdgeOffset<int64_t, TGX_RASTERIZE_SUBPIXEL_BITS>(us, vs, P1, dx2, dy2);
+			O3 = rasterizeEdgeOffset<int64_t, TGX_RASTERIZE_SUBPIXEL_BITS>(us, vs, P2, dx3, dy3);
+			}
+
+		if (sx * sy <= TGX_RASTERIZE_MICRO_AERA)
+			{ // micro triangle: test the few candidate pixels directly and shrink the box to the covered ones (if any).
+			int32_t imin = sx, imax = -1, jmin = sy, jmax = -1;
+			for (int32_t j = 0; j < sy; j++)
+				{
+				int32_t C1 = O1 + (j * dy1);
+				int32_t C2 = O2 + (j * dy2);
+				int32_t C3 = O3 + (j * dy3);
+				for (int32_t i = 0; i < sx; i++)
+					{
+					if ((C1 | C2 | C3) >= 0)
+						{
+						if (i < imin) imin = i;
+						if (i > imax) imax = i;
+						if (j < jmin) jmin = j;
+						jmax = j;
+						}
+					C1 += dx1;
+					C2 += dx2;
+					C3 += dx3;
+					}
+				}
+			if (imax < 0) return; // no pixel center inside the triangle
+			ox += imin;
+			oy += jmin;
+			sx = imax - imin + 1;
+			sy = jmax - jmin + 1;
+			O1 += (imin * dx1) + (jmin * dy1);
+			O2 += (imin * dx2) + (jmin * dy2);
+			O3 += (imin * dx3) + (jmin * dy3);
+			}
+		else if (sx == 1)
 			{
 			while (((O1 | O2 | O3) < 0) && (sy > 0))
 				{
@@ -200,29 +444,41 @@ namespace tgx
 			if (sx == 0) return;
 			}
 
+		data.zpassed = false;
 		if (dx1 > 0)
 			{
-			shader_fun(ox + (data.im->stride() * oy), sx, sy,
+			rasterizeRect(ox, oy, sx, sy,
 				dx1, dy1, O1, fP2,
 				dx2, dy2, O2, V0,
 				dx3, dy3, O3, fP1,
-				data);
+				wmax, data, shader_fun);
 			}
 		else if (dx2 > 0)
 			{
-			shader_fun(ox + (data.im->stride() * oy), sx, sy,
+			rasterizeRect(ox, oy, sx, sy,
 				dx2, dy2, O2, V0,
 				dx3, dy3, O3, fP1,
 				dx1, dy1, O1, fP2,
-				data);
+				wmax, data, shader_fun);
 			}
 		else
 			{
-			shader_fun(ox + (data.im->stride() * oy), sx, sy,
+			rasterizeRect(ox, oy, sx, sy,
 				dx3, dy3, O3, fP1,
 				dx1, dy1, O1, fP2,
 				dx2, dy2, O2, V0,
-				data);
+				wmax, data, shader_fun);
+			}
+
+		// mark the blocks of the rectangle drawn as dirty if any pixel was written (the min. depth
+		// of a block can only increase when drawing so its value remains a valid lower bound otherwise).
+		if ((data.hiz) && (data.zpassed))
+			{
+			for (int32_t by = (oy >> 3); by <= ((oy + sy - 1) >> 3); by++)
+				{
+				float* H = data.hiz + (by * data.hiz_stride);
+				for (int32_t bx = (ox >> 3); bx <= ((ox + sx - 1) >> 3); bx++) H[bx] = -1.0f;
+				}
 			}
 		return;
 
@@ -232,6 +488,9 @@ namespace tgx
 		#undef TGX_RASTERIZE_MULT256
 		#undef TGX_RASTERIZE_MULT128
 		#undef TGX_RASTERIZE_DIV256
+		#undef TGX_RASTERIZE_HIZ_MIN_AERA
+		#undef TGX_RASTERIZE_SMALL_SIZE
+		#undef TGX_RASTERIZE_MICRO_AERA
 		}
 
 
@@ -23,6 +23,7 @@
 
 
 #include "Misc.h"
+#include "Trace.h"
 #include "Color.h"
 #include "Vec2.h"
 #include "Vec3.h"
@@ -37,6 +38,18 @@
 
 #include "Mesh3D.h"
 
+#include <string.h>
+
+#if TGX_MULTITHREAD
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+
+#define TGX_RENDERER3D_MAX_SORTED_MESHES (64) // <- max number of meshes sorted together by drawMesh() and drawMeshes() (uses up to 16 bytes of stack per mesh)
+
 
 
 
@@ -44,6 +57,125 @@ namespace tgx
 {
 
 
+#if TGX_MULTITHREAD
+
+    /**
+    * Pool of persistent worker threads used by Renderer3D::flush() to rasterize the tiles.
+    *
+    * The threads are created the first time they are needed and then wait on a condition
+    * variable for the next job so that flushing the triangle buffer does not spawn (and join)
+    * new threads each time. The threads are stopped when the object is destroyed. Copying
+    * the object does not copy the threads (the copy creates its own when needed).
+    **/
+    class _TileWorkers
+        {
+
+        public:
+
+        static const int MAX_WORKERS = 63; // <- max number of worker threads (in addition to the calling thread)
+
+        _TileWorkers() : _nb(0), _active(0), _pending(0), _gen(0), _quit(false), _fun(nullptr), _ctx(nullptr) {}
+
+        _TileWorkers(const _TileWorkers&) : _TileWorkers() {}
+
+        _TileWorkers& operator=(const _TileWorkers&) { return *this; }
+
+        ~_TileWorkers()
+            {
+                {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _quit = true;
+                }
+            _cv_start.notify_all();
+            for (int k = 0; k < _nb; k++) _threads[k].join();
+            }
+
+
+        /**
+        * Call fun() simultaneously from nbthreads threads: the calling thread and nbthreads - 1
+        * workers. Return when all the calls have returned.
+        **/
+        template<typename FUN> void run(int nbthreads, FUN& fun)
+            {
+            nbthreads = min(nbthreads, MAX_WORKERS + 1);
+            if (nbthreads <= 1) { fun(); return; }
+                {
+                std::lock_guard<std::mutex> lock(_mutex);
+                while (_nb < nbthreads - 1) { _threads[_nb] = std::thread(&_TileWorkers::_loop, this, _nb, _gen); _nb++; }
+                _fun = &_call<FUN>;
+                _ctx = &fun;
+                _active = nbthreads - 1;
+                _pending = _nb;
+                _gen++;
+                }
+            _cv_start.notify_all();
+            fun(); // the calling thread also does its share of the work
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv_done.wait(lock, [&] { return (_pending == 0); });
+            }
+
+
+        private:
+
+        template<typename FUN> static void _call(void* ctx) { (*((FUN*)ctx))(); }
+
+        void _loop(const int index, uint32_t gen)
+            {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true)
+                {
+                _cv_start.wait(lock, [&] { return ((_quit) || (_gen != gen)); });
+                if (_quit) return;
+                gen = _gen;
+                if (index < _active)
+                    {
+                    lock.unlock();
+                    _fun(_ctx);
+                    lock.lock();
+                    }
+                if (--_pending == 0) _cv_done.notify_one();
+                }
+            }
+
+        std::thread _threads[MAX_WORKERS];
+        int         _nb;            // number of threads created
+        int         _active;        // number of workers taking part in the current job
+        int         _pending;       // number of workers that did not finish the current job yet
+        uint32_t    _gen;           // job counter
+        bool        _quit;          // set when the threads must exit
+        void        (*_fun)(void*); // current job
+        void*       _ctx;
+        std::mutex  _mutex;
+        std::condition_variable _cv_start;
+        std::condition_variable _cv_done;
+        };
+
+#endif
+
+
+
+    /**
+    * Rendering statistics returned by Renderer3D::getStats() (only collected when
+    * TGX_RENDERER_STATS is set, otherwise all the counters stay at zero).
+    *
+    * Triangles of quads count as two triangles. Pixel counters are only updated by
+    * the shaders that use depth testing.
+    **/
+    struct RendererStats
+        {
+        uint32_t triangles_submitted;   // triangles given to the renderer.
+        uint32_t triangles_discarded;   // triangles of meshes (or clusters) discarded because their bounding box (or sphere) is outside the view frustum.
+        uint32_t triangles_backface;    // triangles removed by backface culling (including whole clusters removed by their normal cone).
+        uint32_t triangles_clipped;     // triangles dropped because they needed clipping.
+        uint32_t triangles_rasterized;  // triangles sent to the rasterizer (or stored for binned rendering / display lists).
+        uint32_t pixels_tested;         // pixels depth tested.
+        uint32_t pixels_passed;         // pixels that passed the depth test (and were thus written).
+        uint32_t pixels_covered;        // pixels of the image with a non cleared depth (computed by getStats() from the zbuffer).
+        float    overdraw;              // average number of writes per covered pixel: pixels_passed / pixels_covered.
+        };
+
+
+
     /**
     * Class that manages the drawing of 3D objects.
     *
@@ -64,8 +196,17 @@ namespace tgx
     *
     * - ORTHO   : (default false) Set this to use orthographic projection instead of perspective
     *             and thus disable the z-divide after projection.
+    *
+    * - ZBUFFER_t : (default float) Type of the depth buffer: either float, uint16_t or uint32_t.
+    *               A uint16_t zbuffer uses half the memory (and memory bandwidth) but has less
+    *               precision: the depth (1/z for perspective projection and 2 - z for orthographic
+    *               projection) is quantized linearly between the near and far planes.
+    *               A uint32_t zbuffer is an 'epoch' zbuffer: the depth is quantized on 24 bits
+    *               and the 8 remaining bits hold a frame counter. Clearing it with clearZbuffer()
+    *               just increments the counter (the whole buffer is only erased once every 255
+    *               frames) which saves a full pass over the zbuffer each frame.
     **/
-    template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
+    template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t = float>
     class Renderer3D
     {
 
@@ -73,6 +214,7 @@ namespace tgx
         static_assert((LX > 0) && (LX <= MAXVIEWPORTDIMENSION), "Invalid viewport width.");
         static_assert((LY > 0) && (LY <= MAXVIEWPORTDIMENSION), "Invalid viewport height.");
         static_assert(is_color<color_t>::value, "color_t must be one of the color types defined in color.h");
+        static_assert(std::is_same<ZBUFFER_t, float>::value || std::is_same<ZBUFFER_t, uint16_t>::value || std::is_same<ZBUFFER_t, uint32_t>::value, "ZBUFFER_t must be either float, uint16_t or uint32_t");
 
        public:
 
@@ -103,6 +245,7 @@ namespace tgx
         void setImage(Image<color_t>* im)
             {
             _uni.im = im;            
+            if (ZBUFFER) _updateHiZbuffer(false);
             }
 
 
@@ -156,6 +299,7 @@ namespace tgx
             {
             _projM = M;
             _projM.invertYaxis();
+            _updateDepthScale();
             }
 
 
@@ -185,6 +329,7 @@ namespace tgx
             static_assert(ORTHO == true, "the setOrtho() method can only be used with template parameter ORTHO = true");
             _projM.setOrtho(left, right, bottom, top, zNear, zFar);
             _projM.invertYaxis();
+            _updateDepthScale();
             }
 
 
@@ -203,6 +348,7 @@ namespace tgx
             static_assert(ORTHO == false, "the setFrustum() method can only be used with template parameter ORTHO = false (use projectionMatrix().setFrustum() is you really want to...)");
             _projM.setFrustum(left, right, bottom, top, zNear, zFar);
             _projM.invertYaxis();
+            _updateDepthScale();
             }
 
 
@@ -221,6 +367,7 @@ namespace tgx
             static_assert(ORTHO == false, "the setPerspective() method can only be used with template parameter ORTHO = false (use projectionMatrix().setPerspective() is you really want to...)");
             _projM.setPerspective(fovy, aspect, zNear, zFar);
             _projM.invertYaxis();
+            _updateDepthScale();
             }
 
 
@@ -246,16 +393,62 @@ namespace tgx
 
 
         /**
-        * Set the zbuffer and its size (in number of floats).
+        * Set the density used for selecting the level of detail of meshes.
+        *
+        * When a mesh has lower levels of detail (linked via its ->lod member, see createMeshLOD()),
+        * drawMesh() draws the first mesh of the LOD chain whose number of triangles is at most
+        * density * (area in pixels of the bounding box of the mesh projected on the screen).
+        *
+        * Set density <= 0 to disable LOD selection (the mesh is always drawn with full details).
+        * Default value is 0.5 (at most one triangle for every two pixels covered by the bounding box).
+        **/
+        void setLODDensity(float density)
+            {
+            _lod_density = density;
+            }
+
+
+        /**
+        * Set the zbuffer and its size (in number of ZBUFFER_t elements).
         *
         * The zbuffer must be large enough to be used with the image that is being drawn onto.
-        * This means that we must have length >= image.width()*image.height().
+        * It is accessed with the same stride as the image so we must have
+        * length >= (image.height() - 1)*image.stride() + image.width() (which is simply
+        * image.width()*image.height() when the stride of the image is equal to its width).
         **/
-        void setZbuffer(float* zbuffer, int length)
+        void setZbuffer(ZBUFFER_t* zbuffer, int length)
             {
             static_assert(ZBUFFER == true, "the setZbuffer() method can only be used with template parameter ZBUFFER = true");
             _uni.zbuf = zbuffer;
+            _uni.zepoch = 0; // epoch zbuffer: next call to clearZbuffer() erases the whole buffer
             _zbuffer_len = length;
+            _updateHiZbuffer(true);
+            }
+
+
+        /**
+        * Set the hierarchical zbuffer and its size (in number of floats). Set it to nullptr
+        * to disable hierarchical depth testing (default).
+        *
+        * The hierarchical zbuffer holds, for each 8x8 block of the image, the depth of the
+        * farthest pixel in the zbuffer. The rasterizer uses it to discard triangles (and
+        * rows of blocks inside triangles) that are completely hidden before any pixel is
+        * shaded. This speeds up the rendering of scenes with heavy occlusion (especially
+        * when objects are drawn roughly front to back) at the cost of a small overhead
+        * otherwise.
+        *
+        * The buffer must have length >= ((image.width() + 7)/8)*((image.height() + 7)/8) or
+        * it is ignored. It is automatically cleared by clearZbuffer().
+        *
+        * Note: call this method again (or clearZbuffer()) if the zbuffer is modified by
+        *       other means than drawing with the renderer.
+        **/
+        void setHiZbuffer(float* hizbuffer, int length)
+            {
+            static_assert(ZBUFFER == true, "the setHiZbuffer() method can only be used with template parameter ZBUFFER = true");
+            _hiz_buf = hizbuffer;
+            _hiz_len = length;
+            _updateHiZbuffer(true);
             }
 
 
@@ -267,11 +460,123 @@ namespace tgx
         *
         * The zbuffer is intentionally not clear between draw() calls to enable
         * the rendering of multiple objects on the same scene.
+        *
+        * With a uint32_t (epoch) zbuffer, this method only increments the epoch counter
+        * except for the first call after setZbuffer() and once every 255 calls.
         **/
         void clearZbuffer()
             {
             static_assert(ZBUFFER == true, "the clearZbuffer() method can only be used with template parameter ZBUFFER = true");
-            if (_uni.zbuf) memset(_uni.zbuf, 0, _zbuffer_len*sizeof(float));
+            if (_uni.hiz) memset(_uni.hiz, 0, _hiz_len*sizeof(float));
+            if (std::is_same<ZBUFFER_t, uint32_t>::value)
+                {
+                const uint32_t e = _uni.zepoch + (1UL << 24);
+                if ((_uni.zepoch != 0) && (e != 0)) { _uni.zepoch = e; return; } // new epoch: older entries are now seen as cleared.
+                _uni.zepoch = (1UL << 24); // first clear or wrap around: the buffer must really be erased.
+                }
+            if (_uni.zbuf) memset(_uni.zbuf, 0, _zbuffer_len*sizeof(ZBUFFER_t));
+            }
+
+
+        /**
+        * Clear the Zbuffer only inside a given region of the image (e.g. the dirty region
+        * returned by dirtyRegion()). The region is clipped to the image. The blocks of the
+        * hierarchical zbuffer overlapping the region are also reset.
+        **/
+        void clearZbuffer(const iBox2& region)
+            {
+            static_assert(ZBUFFER == true, "the clearZbuffer() method can only be used with template parameter ZBUFFER = true");
+            if ((_uni.zbuf == nullptr) || (_uni.im == nullptr) || (!_uni.im->isValid()) || (_zbuffer_len < _imageBufferLen())) return;
+            const iBox2 B = region & iBox2(0, _uni.im->lx() - 1, 0, _uni.im->ly() - 1);
+            if (B.isEmpty()) return;
+            const int stride = _uni.im->stride();
+            for (int j = B.minY; j <= B.maxY; j++) memset(_uni.zbuf + B.minX + (j * stride), 0, (B.maxX - B.minX + 1) * sizeof(ZBUFFER_t));
+            if (_uni.hiz)
+                {
+                for (int j = (B.minY >> 3); j <= (B.maxY >> 3); j++)
+                    for (int i = (B.minX >> 3); i <= (B.maxX >> 3); i++) _uni.hiz[i + (j * _uni.hiz_stride)] = 0.0f;
+                }
+            }
+
+
+        /**
+        * Return the dirty region: a bounding box (in image coordinates, i.e. taking into
+        * account the current offset) of all the pixels that may have been written by the
+        * renderer since the last call to resetDirtyRegion(). The box is clipped to the
+        * image and may be empty. It is conservative: it is computed from the bounding boxes
+        * of the rasterized triangles (with a 1 pixel margin).
+        *
+        * This makes it possible to clear (and upload to the screen) only the part of the
+        * image that changes from one frame to the next instead of the whole image:
+        *
+        *     iBox2 prev = renderer.dirtyRegion();  // region drawn during the previous frame
+        *     im.fillRect(prev, background);        // erase it...
+        *     renderer.clearZbuffer(prev);          // ...together with the zbuffer
+        *     renderer.resetDirtyRegion();
+        *     renderer.drawMesh(...);               // draw the new frame
+        *     iBox2 upload = prev | renderer.dirtyRegion(); // region of the screen that changed
+        **/
+        iBox2 dirtyRegion() const
+            {
+            if ((_uni.im == nullptr) || (!_uni.im->isValid()) || (_dirty.isEmpty())) return iBox2(1, 0, 1, 0);
+            return iBox2(_dirty.minX - _ox, _dirty.maxX - _ox, _dirty.minY - _oy, _dirty.maxY - _oy) & iBox2(0, _uni.im->lx() - 1, 0, _uni.im->ly() - 1);
+            }
+
+
+        /**
+        * Reset the dirty region (to an empty box). Call this method when starting a new frame.
+        **/
+        void resetDirtyRegion()
+            {
+            _dirty = iBox2(LX, -1, LY, -1); // empty box such that min/max updates need no test.
+            }
+
+
+        /**
+        * Return the rendering statistics accumulated since the last call to resetStats().
+        *
+        * The statistics are only collected when TGX_RENDERER_STATS is set to 1 (before
+        * including tgx.h). Otherwise, the counters are compiled out and all the values
+        * returned are zero.
+        *
+        * pixels_covered and overdraw are computed from the current content of the zbuffer
+        * (so the method should be called after the frame is drawn and the zbuffer should
+        * be cleared at the beginning of the frame). This requires a pass over the zbuffer.
+        **/
+        RendererStats getStats() const
+            {
+            RendererStats st;
+            memset(&st, 0, sizeof(st));
+        #if TGX_RENDERER_STATS
+            st = _stats;
+            st.pixels_tested = _uni.stat_tested;
+            st.pixels_passed = _uni.stat_passed;
+            if ((ZBUFFER) && (_uni.zbuf) && (_uni.im) && (_uni.im->isValid()) && (_zbuffer_len >= _imageBufferLen()))
+                {
+                const int stride = _uni.im->stride();
+                for (int j = 0; j < _uni.im->ly(); j++)
+                    for (int i = 0; i < _uni.im->lx(); i++)
+                        {
+                        if (zbufferDepth(_uni.zbuf[i + (j * stride)], _uni.zepoch) > 0) st.pixels_covered++;
+                        }
+                st.overdraw = (st.pixels_covered > 0) ? ((float)st.pixels_passed / st.pixels_covered) : 0.0f;
+                }
+        #endif
+            return st;
+            }
+
+
+        /**
+        * Reset all the rendering statistics counters. Call this method at the beginning of
+        * each frame to get per frame statistics.
+        **/
+        void resetStats()
+            {
+        #if TGX_RENDERER_STATS
+            memset(&_stats, 0, sizeof(_stats));
+            _uni.stat_tested = 0;
+            _uni.stat_passed = 0;
+        #endif
             }
 
 
@@ -286,6 +591,279 @@ namespace tgx
             }
 
 
+        /**
+        * Enable/disable tiled texture layout.
+        * When enabled, every texture used for rendering must have been converted beforehand with
+        * Image::copyTiled(): the texels are then stored by blocks of 4x4 which improves memory
+        * locality when a triangle walks the texture diagonally or along columns.
+        * Mip chains (Mesh3D::mipmap) are ignored while this option is set.
+        * default value = false.
+        **/
+        void useTiledTextures(bool enable)
+            {
+            _uni.use_tiled_textures = enable;
+            }
+
+
+        /**
+        * Set the length of the subspans used for perspective correct texturing.
+        *
+        * By default (subspan = 0), the texture coordinates are recovered with a division at
+        * every pixel. With subspan = N > 1, they are computed exactly only every N pixels and
+        * interpolated linearly in between, which removes most of the per pixel divisions of the
+        * texture shaders (typical values: 8 or 16).
+        *
+        * max_error bounds the error of the interpolation (in texels): subspans where the
+        * perspective distortion is too large for the bound to hold (triangles seen at a grazing
+        * angle, close to the camera) are still computed exactly.
+        *
+        * Only used with a perspective projection (texturing is always affine with an
+        * orthographic projection).
+        **/
+        void setTextureSubspan(int subspan, float max_error = 0.5f)
+            {
+            _uni.tex_subspan = (subspan > 1) ? subspan : 0;
+            _uni.tex_subspan_maxerr = max(max_error, 0.0f);
+            }
+
+
+        /**
+        * Set the buffer used to store the triangles when binned rendering is enabled.
+        *
+        * Each triangle drawn while binned rendering is active is transformed, culled and
+        * projected right away but its rasterization is deferred until flush() is called.
+        * If the buffer becomes full, flush() is called automatically.
+        **/
+        void setTriangleBuffer(RasterizerTriangle<color_t>* buffer, int nb_triangles)
+            {
+            _bin_buf = buffer;
+            _bin_size = (buffer == nullptr) ? 0 : nb_triangles;
+            _bin_nb = 0;
+            }
+
+
+        /**
+        * Set the buffer holding, for each tile, the list of the triangles that overlap it
+        * (and its size in number of uint32_t).
+        *
+        * When set, the triangles are sorted into the lists of the tiles they overlap as soon
+        * as they are stored in the triangle buffer so that flush() rasterizes each tile using
+        * only its own triangles. Otherwise, each tile has to test the bounding box of every
+        * triangle stored, which becomes costly with many tiles and triangles.
+        *
+        * The buffer holds 2 entries per tile plus 2 entries for each (triangle, tile) pair so
+        * length = 2*nb_tiles + 4*nb_triangles is usually enough (with nb_triangles the size
+        * of the triangle buffer). If the lists become full, flush() is called automatically.
+        * The buffer is also used by replay() (display lists are then processed in several
+        * batches if needed).
+        **/
+        void setTileListBuffer(uint32_t* buffer, int length)
+            {
+            flush();
+            _tl_buf = buffer;
+            _tl_len = (buffer == nullptr) ? 0 : length;
+            _tl_valid = false;
+            }
+
+
+        /**
+        * Enable/disable binned rendering.
+        *
+        * When enabled (and a triangle buffer was set with setTriangleBuffer()), the drawing
+        * methods only perform the geometry stage (vertex transform, lightning, culling and
+        * projection), once for each triangle, and store the result in the triangle buffer.
+        * A subsequent call to flush() splits the image in tiles and rasterizes every tile
+        * with the triangles that overlap it (see also setTileListBuffer()). When
+        * TGX_MULTITHREAD is set, the tiles are dispatched between several worker threads
+        * which are created once and then reused by every call to flush().
+        *
+        * - tile_lx, tile_ly : size of the tiles (rounded up to a multiple of 8).
+        *
+        * - nb_threads : number of threads used by flush() (including the calling thread).
+        *                Set it to 0 to use as many threads as there are hardware cores.
+        *                Ignored when TGX_MULTITHREAD = 0.
+        *
+        * Remark: the triangles are rasterized with the image, zbuffer, offset and texturing
+        * options set when flush() is called.
+        **/
+        void setBinnedRendering(bool enable, int tile_lx = 128, int tile_ly = 64, int nb_threads = 0)
+            {
+            if ((!enable) && (_bin_enabled)) flush();
+            _bin_enabled = enable;
+            _bin_tlx = (max(tile_lx, 8) + 7) & (~7);
+            _bin_tly = (max(tile_ly, 8) + 7) & (~7);
+            _bin_threads = max(nb_threads, 0);
+            }
+
+
+        /**
+        * Set the visibility buffer used for deferred rendering and its size (in number of uint32_t).
+        *
+        * The visibility buffer must be large enough to be used with the image that is being
+        * drawn onto. It is accessed with the same stride as the image (like the zbuffer) so
+        * we must have length >= (image.height() - 1)*image.stride() + image.width().
+        **/
+        void setVisibilityBuffer(uint32_t* vbuffer, int length)
+            {
+            static_assert(ZBUFFER == true, "the setVisibilityBuffer() method can only be used with template parameter ZBUFFER = true");
+            _vis_buf = vbuffer;
+            _vis_len = (vbuffer == nullptr) ? 0 : length;
+            }
+
+
+        /**
+        * Enable/disable deferred rendering.
+        *
+        * Deferred rendering requires a triangle buffer (set with setTriangleBuffer()) and a
+        * visibility buffer (set with setVisibilityBuffer()). When enabled, triangles are
+        * stored in the triangle buffer as with binned rendering. Then, for each tile, flush()
+        * performs two passes:
+        *
+        * 1. Visibility pass: the triangles are rasterized with depth testing but without any
+        *    shading: only the index of the visible triangle is written in the visibility
+        *    buffer for each pixel.
+        *
+        * 2. Resolve pass: each pixel of the visibility buffer is shaded exactly once using
+        *    the attributes (color, texture coords) of the triangle it holds.
+        *
+        * Thus the cost of shading (texturing in particular) does not depend on the depth
+        * complexity of the scene anymore. Tile size and number of threads are those set with
+        * setBinnedRendering() (which does not need to be enabled).
+        *
+        * Remark: the image is only written during the resolve pass so the pixels where no
+        *         triangle is drawn keep their previous color.
+        **/
+        void setDeferredRendering(bool enable)
+            {
+            static_assert(ZBUFFER == true, "the setDeferredRendering() method can only be used with template parameter ZBUFFER = true");
+            if ((!enable) && (_deferred)) flush();
+            _deferred = enable;
+            }
+
+
+        /**
+        * Rasterize all the triangles currently stored in the triangle buffer and then
+        * empty it. Does nothing if binned/deferred rendering is not used.
+        *
+        * Returns: 0  OK
+        *          -1 invalid image
+        *          -2 invalid detph buffer
+        **/
+        int flush();
+
+
+        /**
+        * Start recording a display list.
+        *
+        * While recording, the drawing methods do not draw anything: the triangles are
+        * transformed, lit, projected and clipped as usual and then stored in the user supplied
+        * 'buffer' (which can hold at most 'size' triangles). The triangles are recorded for the
+        * whole viewport (and not only for the part covered by the current image) so that the
+        * display list can later be replayed with replay() onto every tile of the viewport
+        * (i.e. with different offsets set with setOffset()) without having to redo any
+        * geometry work.
+        *
+        * Remarks:
+        * - An image (and a zbuffer when ZBUFFER = true) must still be set while recording.
+        * - The recorded triangles depend on the view and projection matrices, the lights,
+        *   the model matrices and the materials used when recording: the display list can be
+        *   replayed as many times as needed (for each tile and for subsequent frames) as long
+        *   as these do not change. Otherwise, it must be recorded again.
+        * - The display list refers to the textures used when recording: they must remain valid.
+        **/
+        void beginRecording(RasterizerTriangle<color_t>* buffer, int size)
+            {
+            flush(); // draw the triangles binned before starting the recording
+            _rec_buf = buffer;
+            _rec_size = (buffer == nullptr) ? 0 : size;
+            _rec_nb = 0;
+            _rec_overflow = false;
+            _recording = (_rec_size > 0);
+            }
+
+
+        /**
+        * Stop recording the display list.
+        *
+        * Returns the number of triangles in the display list or -1 if the buffer passed to
+        * beginRecording() was too small (the display list is then incomplete).
+        **/
+        int endRecording()
+            {
+            _recording = false;
+            return (_rec_overflow ? -1 : _rec_nb);
+            }
+
+
+        /**
+        * Replay a display list recorded with beginRecording()/endRecording() onto the current
+        * image (taking into account its offset inside the viewport).
+        *
+        * - list : the triangle buffer that was passed to beginRecording()
+        * - nb   : number of triangles in the display list (returned by endRecording()).
+        *
+        * The triangles are rasterized with the usual depth testing, texturing options and
+        * (if enabled) deferred rendering. Triangles outside of the image are skipped. The
+        * image is processed by tiles (whose size and number of threads are those set with
+        * setBinnedRendering()).
+        *
+        * Returns: 0  OK
+        *          -1 invalid image
+        *          -2 invalid detph buffer
+        **/
+        int replay(const RasterizerTriangle<color_t>* list, int nb)
+            {
+            if (_recording) return 0;
+            flush(); // draw the binned triangles first to respect the drawing order
+            const int r = _flushTriangles(list, nb);
+            if ((r == 0) && (list != nullptr))
+                {
+                for (int k = 0; k < nb; k++) _markDirty(list[k].xmin, list[k].xmax, list[k].ymin, list[k].ymax);
+                }
+            return r;
+            }
+
+
+        /**
+        * Set the scratch buffer used as a post-transform vertex cache by drawMesh().
+        *
+        * When a vertex cache is set, drawMesh() transforms and projects each vertex (and
+        * each normal vector) of a mesh exactly once per call and stores the result in the
+        * buffer from where it is retrieved every time a triangle refers to it. Otherwise
+        * (default) the attributes of a vertex are computed again every time a new chain of
+        * triangles reaches it.
+        *
+        * - buffer : pointer to the scratch memory (aligned to 4 bytes) or nullptr to disable
+        *            the vertex cache.
+        * - size   : size of the buffer in bytes. A mesh is drawn using the vertex cache only
+        *            if size >= vertexCacheSize(mesh), other meshes are drawn normally.
+        **/
+        void setVertexCache(void* buffer, int size)
+            {
+            _vcache_buf = buffer;
+            _vcache_len = (buffer == nullptr) ? 0 : size;
+            _vcache_stamp = 0;
+            if (_vcache_buf) memset(_vcache_buf, 0, _vcache_len);
+            }
+
+
+        /**
+        * Return the size (in bytes) of the vertex cache needed to draw a given mesh (and
+        * all the meshes chained to it) when using setVertexCache().
+        **/
+        static int vertexCacheSize(const Mesh3D<color_t>* mesh)
+            {
+            int size = 0;
+            while (mesh)
+                {
+                const int s = (int)(mesh->nb_vertices * sizeof(_VCacheVertex) + mesh->nb_normals * sizeof(_VCacheNormal));
+                if (s > size) size = s;
+                mesh = mesh->next;
+                }
+            return size;
+            }
+
+
         /*****************************************************************************************
         ******************************************************************************************
         *
@@ -628,6 +1206,12 @@ namespace tgx
         *                                     slowest method because each draw call has an additional
         *                                     overhead.
         *
+        *
+        * (5) When binned rendering is enabled (see setBinnedRendering()), the drawing methods only
+        *     store the projected triangles and the actual rasterization occurs when flush() is called.
+        *
+        *     ***  DO NOT FORGET TO CALL flush() BEFORE USING THE IMAGE IN BINNED MODE :-) ***
+        *
         ******************************************************************************************
         ******************************************************************************************/
 
@@ -658,11 +1242,87 @@ namespace tgx
         *
         * - draw_chained_meshes  If true, the meshes linked to this mesh (via the ->next member) are also drawn.
         *
+        * - sort_front_to_back   If true (and draw_chained_meshes = true), the chained meshes are drawn
+        *                        from front to back (according to the view space depth of the center of
+        *                        their bounding box) instead of their order in the chain. When depth testing
+        *                        is enabled, this lets the zbuffer reject hidden pixels before they are
+        *                        shaded instead of overwriting them. At most TGX_RENDERER3D_MAX_SORTED_MESHES
+        *                        meshes are sorted together: longer chains are sorted by consecutive groups.
+        *
+        * The method returns  0 ok, (drawing performed correctly).
+        *                    -1 invalid image
+        *                    -2 invalid zbuffer (only when template parameter ZBUFFER=true)
+        **/
+        int drawMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material = true, bool draw_chained_meshes = true, bool sort_front_to_back = false);
+
+
+        /**
+        * Draw several meshes (each one with its own model matrix) from front to back.
+        *
+        * The meshes are sorted according to the view space depth of the center of their bounding
+        * box (after applying their model matrix) and then drawn from the closest to the farthest one.
+        * With depth testing, this reduces overdraw since the hidden parts of the meshes drawn last
+        * are discarded by the zbuffer before shading.
+        *
+        * - shader         Type of shader to use (same as drawMesh()).
+        *
+        * - nb_meshes      Number of meshes to draw. At most TGX_RENDERER3D_MAX_SORTED_MESHES meshes are
+        *                  sorted together: larger batches are sorted by consecutive groups.
+        *
+        * - meshes         Array of pointers to the meshes to draw (nullptr entries are skipped).
+        *
+        * - model_matrices Array of model matrices: model_matrices[i] is used when drawing meshes[i].
+        *                  If nullptr, all meshes are drawn with the current model matrix.
+        *
+        * - use_mesh_material   Same as drawMesh().
+        *
+        * - draw_chained_meshes If true, the meshes linked to meshes[i] (via the ->next member) are drawn
+        *                       together with meshes[i] (with the same model matrix).
+        *
+        * The current model matrix is restored when the method returns.
+        *
+        * The method returns  0 ok, (drawing performed correctly).
+        *                    -1 invalid image
+        *                    -2 invalid zbuffer (only when template parameter ZBUFFER=true)
+        **/
+        int drawMeshes(const int shader, int nb_meshes, const Mesh3D<color_t>* const* meshes, const fMat4* model_matrices = nullptr, bool use_mesh_material = true, bool draw_chained_meshes = false);
+
+
+        /**
+        * Draw several instances of the same mesh, each one with its own model matrix (and color).
+        *
+        * This is faster than calling setModelMatrix() and drawMesh() for each instance because
+        * the setup of the mesh (material, specular table, shader selection) is performed only
+        * once for a whole batch of instances. The instances are processed by batches of
+        * TGX_RENDERER3D_MAX_SORTED_MESHES: the instances of a batch are first culled against the
+        * viewport (using the bounding box of the mesh) and the visible ones are sorted from front
+        * to back before being drawn. The level of detail (see setLODDensity()) is selected
+        * independently for each instance.
+        *
+        * - shader     Type of shader to use (same as drawMesh()).
+        *
+        * - mesh       The mesh to draw.
+        *
+        * - models     Array of model matrices: models[i] is the model matrix of the i-th instance.
+        *
+        * - count      Number of instances.
+        *
+        * - colors     Optional array of colors: colors[i] is the color of the i-th instance which
+        *              replaces the object/mesh color when texturing is not used. If nullptr, the
+        *              instances are drawn with the usual color.
+        *
+        * - use_mesh_material   Same as drawMesh().
+        *
+        * - draw_chained_meshes If true, the meshes linked to this mesh (via the ->next member) are
+        *                       also drawn for each instance.
+        *
+        * The current model matrix is restored when the method returns.
+        *
         * The method returns  0 ok, (drawing performed correctly).
         *                    -1 invalid image
         *                    -2 invalid zbuffer (only when template parameter ZBUFFER=true)
         **/
-        int drawMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material = true, bool draw_chained_meshes = true);
+        int drawMeshInstanced(const int shader, const Mesh3D<color_t>* mesh, const fMat4* models, int count, const RGBf* colors = nullptr, bool use_mesh_material = true, bool draw_chained_meshes = true);
 
 
 
@@ -684,7 +1344,7 @@ namespace tgx
                          const fVec3& P1, const fVec3& P2, const fVec3& P3)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             _drawTriangle(TGX_SHADER_FLAT, &P1, &P2, &P3, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, _r_objectColor, _r_objectColor, _r_objectColor);
             return 0;
@@ -739,7 +1399,7 @@ namespace tgx
                          const fVec3 & N1, const fVec3 & N2, const fVec3 & N3)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed            
             TGX_SHADER_REMOVE_TEXTURE(shader) // disable texturing
             _drawTriangle(shader, &P1, &P2, &P3, &N1, &N2, &N3, nullptr, nullptr, nullptr, _r_objectColor, _r_objectColor, _r_objectColor);
@@ -773,7 +1433,7 @@ namespace tgx
                      const RGBf & col1, const RGBf & col2, const RGBf & col3)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             if (TGX_SHADER_HAS_GOURAUD(shader))
                 {
@@ -817,7 +1477,7 @@ namespace tgx
                         const Image<color_t>* texture)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             TGX_SHADER_REMOVE_GOURAUD(shader)
             if (TGX_SHADER_HAS_TEXTURE(shader))
@@ -862,7 +1522,7 @@ namespace tgx
                         const Image<color_t>* texture)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             if (TGX_SHADER_HAS_TEXTURE(shader))
                 { // store the texture
@@ -874,12 +1534,87 @@ namespace tgx
             }
 
 
-
         /**
-        * Draw a list of triangles on the image. If texture mapping is not used, then the current
-        * material color is used to draw the triangles.
+        * Draw a single triangle on the image with a user defined fragment shader.
         *
-        * - shader       Combination of TGX_SHADER_FLAT/TGX_SHADER_GOURAUD and TGX_SHADER_TEXTURE
+        * - (P1,P2,P3)  coordinates (in model space) of the triangle to draw
+        *
+        *               *** MAKE SURE THAT THE TRIANGLE IS GIVEN WITH THE CORRECT WINDING ORDER ***
+        *
+        * - (var1,var2,var3) user defined varying parameters associated with (P1, P2, P3). VARYINGS
+        *               is a struct that must only contain floats (float, fVec2, fVec3, RGBf...).
+        *
+        * - frag        functor called for each pixel drawn with the interpolated varyings
+        *               (perspective correct). It must provide the method
+        *
+        *                   color_t operator()(const VARYINGS& var, const float w) const
+        *
+        *               where w is 1/z with perspective projection and 2 - z with orthographic
+        *               projection. The call is inlined in the span loop (see ShaderFunctor).
+        *
+        * The triangle is not lit: the functor computes the final color. It is always drawn
+        * immediately, even when binned/deferred rendering is enabled or when a display list
+        * is being recorded.
+        *
+        * Returns: 0  OK
+        *          -1 invalid image
+        *          -2 invalid detph buffer
+        **/
+        template<typename VARYINGS, typename FRAGMENT>
+        int drawTriangleWithShader(const fVec3& P1, const fVec3& P2, const fVec3& P3,
+                                   const VARYINGS& var1, const VARYINGS& var2, const VARYINGS& var3,
+                                   const FRAGMENT& frag)
+            {
+            if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
+            _drawTriangleWithShader(P1, P2, P3, var1, var2, var3, ShaderFunctor<ZBUFFER, ORTHO, FRAGMENT>(frag));
+            return 0;
+            }
+
+
+        /**
+        * Draw a list of triangles on the image with a user defined fragment shader.
+        *
+        * - nb_triangles Number of triangles to draw.
+        *
+        * - ind_vertices Array of vertex indexes. The length of the array is nb_triangles*3
+        *                and each 3 consecutive values represent a triangle.
+        *
+        *               *** MAKE SURE THAT THE TRIANGLES ARE GIVEN WITH THE CORRECT WINDING ORDER ***
+        *
+        * - vertices     The array of vertices (given in model space).
+        *
+        * - varyings     The array of varying parameters of each vertex (same indexes as vertices).
+        *
+        * - frag         The fragment shader functor. See drawTriangleWithShader().
+        *
+        * Returns: 0  OK
+        *          -1 invalid image
+        *          -2 invalid detph buffer
+        **/
+        template<typename VARYINGS, typename FRAGMENT>
+        int drawTrianglesWithShader(int nb_triangles, const uint16_t* ind_vertices, const fVec3* vertices,
+                                    const VARYINGS* varyings, const FRAGMENT& frag)
+            {
+            if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
+            if ((ind_vertices == nullptr) || (vertices == nullptr) || (varyings == nullptr)) return 0;
+            const ShaderFunctor<ZBUFFER, ORTHO, FRAGMENT> shader(frag);
+            for (int n = 0; n < nb_triangles; n++)
+                {
+                const int i0 = ind_vertices[3 * n], i1 = ind_vertices[3 * n + 1], i2 = ind_vertices[3 * n + 2];
+                _drawTriangleWithShader(vertices[i0], vertices[i1], vertices[i2], varyings[i0], varyings[i1], varyings[i2], shader);
+                }
+            return 0;
+            }
+
+
+
+        /**
+        * Draw a list of triangles on the image. If texture mapping is not used, then the current
+        * material color is used to draw the triangles.
+        *
+        * - shader       Combination of TGX_SHADER_FLAT/TGX_SHADER_GOURAUD and TGX_SHADER_TEXTURE
         *                Some flag may be ignored if the corresponding required arrays
         *                are missing (i.e. a normal array for TGX_SHADER_GOURAUD, and a texture
         *                array and a texture image for TGX_SHADER_TEXTURE).
@@ -944,7 +1679,7 @@ namespace tgx
                      const fVec3& P1, const fVec3& P2, const fVec3& P3, const fVec3& P4)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             _drawQuad(shader, &P1, &P2, &P3, &P4, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, _r_objectColor, _r_objectColor, _r_objectColor, _r_objectColor);
             return 0;
@@ -1004,7 +1739,7 @@ namespace tgx
                      const fVec3& N1, const fVec3& N2, const fVec3& N3, const fVec3& N4)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             TGX_SHADER_REMOVE_TEXTURE(shader) // disable texturing
             _drawQuad(shader, &P1, &P2, &P3, &P4, &N1, &N2, &N3, &N4, nullptr, nullptr, nullptr, nullptr, _r_objectColor, _r_objectColor, _r_objectColor, _r_objectColor);
@@ -1040,7 +1775,7 @@ namespace tgx
                      const RGBf & col1, const RGBf & col2, const RGBf & col3, const RGBf & col4)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             if (TGX_SHADER_HAS_GOURAUD(shader))
                 {
@@ -1084,7 +1819,7 @@ namespace tgx
                      const Image<color_t>* texture)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             TGX_SHADER_REMOVE_GOURAUD(shader) // disable gouraud
             if (TGX_SHADER_HAS_TEXTURE(shader))
@@ -1131,7 +1866,7 @@ namespace tgx
                      const Image<color_t>* texture)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             _precomputeSpecularTable(_specularExponent); // precomputed pow(.specularexpo) if needed
             if (TGX_SHADER_HAS_TEXTURE(shader))
                 { // store the texture
@@ -1216,10 +1951,129 @@ namespace tgx
         ************************************************************/
 
 
+        /** Vertex entry in the post-transform vertex cache. */
+        struct _VCacheVertex
+            {
+            fVec4 P;            // after model-view matrix multiplication
+            fVec4 S;            // after projection (normalized coords)
+            uint32_t stamp;     // drawMesh() call the entry was computed for
+            bool clip;          // true if a triangle using this vertex must be clipped
+            };
+
+
+        /** Normal entry in the post-transform vertex cache. */
+        struct _VCacheNormal
+            {
+            fVec3 N;            // normal vector after model-view matrix multiplication
+            RGBf color;         // vertex color (only when culling is enabled)
+            uint32_t stamp;     // drawMesh() call the entry was computed for
+            };
+
+
+        /** Draw a single mesh (not its chained meshes). Called by drawMesh() and drawMeshes(). */
+        void _drawSingleMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material);
+
+
+        /** Set the material for drawing a mesh and return the shader that can be used with it. */
+        int _setupMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material);
+
+
+        /** Call _drawMesh() with the template parameter corresponding to raster_type. */
+        void _drawMeshRaster(const int raster_type, const Mesh3D<color_t>* mesh);
+
+
+        /** Return the view space depth of the center of a mesh bounding box (larger is farther). */
+        float _meshDepth(const Mesh3D<color_t>* mesh) const
+            {
+            return -_r_modelViewM.mult1(mesh->bounding_box.center()).z;
+            }
+
+
+        /** Select the level of detail to use for drawing a mesh according to its size on the screen. */
+        const Mesh3D<color_t>* _selectLOD(const Mesh3D<color_t>* mesh)
+            {
+            if ((mesh->lod == nullptr) || (_lod_density <= 0)) return mesh;
+            const fBox3& bb = mesh->bounding_box;
+            if ((bb.minX == 0) && (bb.maxX == 0) && (bb.minY == 0) && (bb.maxY == 0) && (bb.minZ == 0) && (bb.maxZ == 0))
+                return mesh; // bounding box is uninitialized.
+            const fMat4 M = _projM * _r_modelViewM;
+            float xmin = 2, xmax = -2, ymin = 2, ymax = -2;
+            for (int k = 0; k < 8; k++)
+                {
+                fVec4 S = M.mult1(fVec3((k & 1) ? bb.maxX : bb.minX, (k & 2) ? bb.maxY : bb.minY, (k & 4) ? bb.maxZ : bb.minZ));
+                if (!ORTHO)
+                    {
+                    if (S.w <= 0) return mesh; // box crosses the camera plane: use full details
+                    S.zdivide();
+                    }
+                xmin = min(xmin, S.x); xmax = max(xmax, S.x);
+                ymin = min(ymin, S.y); ymax = max(ymax, S.y);
+                }
+            const float aera = (xmax - xmin) * (ymax - ymin) * (LX * LY * 0.25f);
+            const float maxfaces = _lod_density * aera;
+            while ((mesh->lod) && (mesh->nb_faces > maxfaces)) mesh = mesh->lod;
+            return mesh;
+            }
+
+
+        /** Sort an array of indices by increasing depth (insertion sort: the arrays are small). */
+        static void _sortByDepth(int nb, float* depth, int* ind)
+            {
+            for (int i = 1; i < nb; i++)
+                {
+                const float d = depth[i];
+                const int k = ind[i];
+                int j = i - 1;
+                while ((j >= 0) && (depth[j] > d)) { depth[j + 1] = depth[j]; ind[j + 1] = ind[j]; j--; }
+                depth[j + 1] = d;
+                ind[j + 1] = k;
+                }
+            }
+
+
         /** Method called by drawMesh() which does the actual drawing. */
         template<int RASTER_TYPE> void _drawMesh(const Mesh3D<color_t>* mesh);
 
 
+        /** Same as _drawMesh() but use the post-transform vertex cache. */
+        template<int RASTER_TYPE> void _drawMeshCached(const Mesh3D<color_t>* mesh, const bool mesh_cliptestneeded);
+
+
+        /** Return the vertex cache entry for a given vertex (computing it if needed). */
+        TGX_INLINE const auto & _cachedVertex(const MeshReader<color_t>& reader, const int index, const bool cliptestneeded)
+            {
+            static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
+            _VCacheVertex& V = ((_VCacheVertex*)_vcache_buf)[index];
+            if (V.stamp != _vcache_stamp)
+                {
+                V.stamp = _vcache_stamp;
+                V.P = _r_modelViewM.mult1(reader.vertex(index));
+                V.S = _projM * V.P;
+                if (ORTHO) { V.S.w = 2.0f - V.S.z; }
+                else { V.S.zdivide(); }
+                V.clip = (cliptestneeded) && ((V.P.z >= 0)
+                    | (V.S.x < -clipboundXY) | (V.S.x > clipboundXY)
+                    | (V.S.y < -clipboundXY) | (V.S.y > clipboundXY)
+                    | (V.S.z < -1) | (V.S.z > 1));
+                }
+            return V;
+            }
+
+
+        /** Return the vertex cache entry for a given normal (computing it if needed). */
+        template<bool TEXTURE> TGX_INLINE const auto & _cachedNormal(_VCacheNormal* tab_ncache, const MeshReader<color_t>& reader, const int index)
+            {
+            _VCacheNormal& N = tab_ncache[index];
+            if (N.stamp != _vcache_stamp)
+                {
+                N.stamp = _vcache_stamp;
+                N.N = _r_modelViewM.mult0(reader.normal(index));
+                if (_culling_dir != 0) N.color = _phong<TEXTURE>(dotProduct(N.N, _r_light_inorm), dotProduct(N.N, _r_H_inorm));
+                }
+            return N;
+            }
+
+
 
         /** draw a single triangle */
         void _drawTriangle(const int RASTER_TYPE,
@@ -1238,7 +2092,8 @@ namespace tgx
             // face culling
             fVec3 faceN = crossProduct(Q1 - Q0, Q2 - Q0);
             const float cu = (ORTHO) ? dotProduct(faceN, fVec3(0.0f, 0.0f, -1.0f)) : dotProduct(faceN, Q0);
-            if (cu * _culling_dir > 0) return; // skip triangle !
+            TGX_STAT(_stats.triangles_submitted++);
+            if (cu * _culling_dir > 0) { TGX_STAT(_stats.triangles_backface++); return; } // skip triangle !
 
             RasterizerVec4 PC0, PC1, PC2;
 
@@ -1265,7 +2120,7 @@ namespace tgx
                      | (PC2.y < -clipboundXY) | (PC2.y > clipboundXY)
                      | (PC2.z < -1) | (PC2.z > 1);
 
-            if (needclip) return; // we just drop triangle that need clipping (TODO : improve this !)
+            if (needclip) { TGX_STAT(_stats.triangles_clipped++); return; } // we just drop triangle that need clipping (TODO : improve this !)
 
 
             // compute phong lightning
@@ -1313,13 +2168,70 @@ namespace tgx
                 }
 
             // go rasterize !          
-            rasterizeTriangle<LX, LY>(PC0, PC1, PC2, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
+            _rasterizeTriangle(PC0, PC1, PC2);
 
             return;
             }
 
 
 
+        /** draw a single triangle with a user defined shader functor (no lighting, not binned) */
+        template<typename VARYINGS, typename SHADER>
+        void _drawTriangleWithShader(const fVec3& P0, const fVec3& P1, const fVec3& P2,
+                                     const VARYINGS& var0, const VARYINGS& var1, const VARYINGS& var2,
+                                     const SHADER& shader)
+            {
+            // compute position in wiew space.
+            const fVec4 Q0 = _r_modelViewM.mult1(P0);
+            const fVec4 Q1 = _r_modelViewM.mult1(P1);
+            const fVec4 Q2 = _r_modelViewM.mult1(P2);
+
+            // face culling
+            const fVec3 faceN = crossProduct(Q1 - Q0, Q2 - Q0);
+            const float cu = (ORTHO) ? dotProduct(faceN, fVec3(0.0f, 0.0f, -1.0f)) : dotProduct(faceN, Q0);
+            TGX_STAT(_stats.triangles_submitted++);
+            if (cu * _culling_dir > 0) { TGX_STAT(_stats.triangles_backface++); return; } // skip triangle !
+
+            RasterizerVertex<VARYINGS> PC0, PC1, PC2;
+
+            // test if clipping is needed
+            static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
+
+            (*((fVec4*)&PC0)) = _projM * Q0;
+            if (ORTHO) { PC0.w = 2.0f - PC0.z; } else { PC0.zdivide(); }
+            bool needclip = (Q0.z >= 0)
+                          | (PC0.x < -clipboundXY) | (PC0.x > clipboundXY)
+                          | (PC0.y < -clipboundXY) | (PC0.y > clipboundXY)
+                          | (PC0.z < -1) | (PC0.z > 1);
+            (*((fVec4*)&PC1)) = _projM * Q1;
+            if (ORTHO) { PC1.w = 2.0f - PC1.z; } else { PC1.zdivide(); }
+            needclip |= (Q1.z >= 0)
+                     | (PC1.x < -clipboundXY) | (PC1.x > clipboundXY)
+                     | (PC1.y < -clipboundXY) | (PC1.y > clipboundXY)
+                     | (PC1.z < -1) | (PC1.z > 1);
+            (*((fVec4*)&PC2)) = _projM * Q2;
+            if (ORTHO) { PC2.w = 2.0f - PC2.z; } else { PC2.zdivide(); }
+            needclip |= (Q2.z >= 0)
+                     | (PC2.x < -clipboundXY) | (PC2.x > clipboundXY)
+                     | (PC2.y < -clipboundXY) | (PC2.y > clipboundXY)
+                     | (PC2.z < -1) | (PC2.z > 1);
+
+            if (needclip) { TGX_STAT(_stats.triangles_clipped++); return; } // we just drop triangle that need clipping (TODO : improve this !)
+
+            PC0.var = var0;
+            PC1.var = var1;
+            PC2.var = var2;
+
+            // go rasterize !
+            TGX_STAT(_stats.triangles_rasterized++);
+            int xmin, xmax, ymin, ymax;
+            _triangleBox(PC0, PC1, PC2, xmin, xmax, ymin, ymax);
+            _markDirty(xmin, xmax, ymin, ymax);
+            rasterizeTriangle<LX, LY>(PC0, PC1, PC2, _ox, _oy, _uni, shader);
+            }
+
+
+
         /** draw a single quad : the 4 points are assumed to be coplanar */
         void _drawQuad(const int RASTER_TYPE,
             const fVec3* P0, const fVec3* P1, const fVec3* P2, const fVec3* P3,
@@ -1337,7 +2249,8 @@ namespace tgx
             // face culling (use triangle (0 1 2), doesn't matter since 0 1 2 3 are coplanar.
             fVec3 faceN = crossProduct(Q1 - Q0, Q2 - Q0);
             const float cu = (ORTHO) ? dotProduct(faceN, fVec3(0.0f, 0.0f, -1.0f)) : dotProduct(faceN, Q0);
-            if (cu * _culling_dir > 0) return; // Q3 is coplanar with Q0, Q1, Q2 so we discard the whole quad.
+            TGX_STAT(_stats.triangles_submitted += 2);
+            if (cu * _culling_dir > 0) { TGX_STAT(_stats.triangles_backface += 2); return; } // Q3 is coplanar with Q0, Q1, Q2 so we discard the whole quad.
 
             const fVec4 Q3 = _r_modelViewM.mult1(*P3); // compute fourth point
 
@@ -1375,7 +2288,7 @@ namespace tgx
                      | (PC3.y < -clipboundXY) | (PC3.y > clipboundXY)
                      | (PC3.z < -1) | (PC3.z > 1);
 
-            if (needclip) return; // just discard the whole quad (TODO : improve this !)
+            if (needclip) { TGX_STAT(_stats.triangles_clipped += 2); return; } // just discard the whole quad (TODO : improve this !)
 
             // compute phong lightning
             if (TGX_SHADER_HAS_GOURAUD(RASTER_TYPE))
@@ -1426,14 +2339,434 @@ namespace tgx
                 }
 
             // go rasterize !
-            rasterizeTriangle<LX, LY>(PC0, PC1, PC2, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
-            rasterizeTriangle<LX, LY>(PC0, PC2, PC3, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
+            _rasterizeTriangle(PC0, PC1, PC2);
+            _rasterizeTriangle(PC0, PC2, PC3);
             
             return;
             }
 
 
 
+        /***********************************************************
+        * DEPTH QUANTIZATION
+        ************************************************************/
+
+
+        /** set how the depth is stored in the zbuffer (quantization is only used with a uint16_t or uint32_t zbuffer). */
+        void _updateDepthScale()
+            {
+            _uni.zoff = 0.0f;
+            _uni.zmul = 1.0f;
+            if (std::is_same<ZBUFFER_t, float>::value) return; // float zbuffer: store w as is.
+            const float hmax = (std::is_same<ZBUFFER_t, uint16_t>::value) ? 32767.0f : 8388607.0f; // half of the max. quantized depth (16 or 24 bits)
+            if (ORTHO)
+                { // w = 2 - z in [1,3] is mapped to [0.5, 2*hmax + 0.5]
+                _uni.zoff = (0.5f / hmax) - 1.0f;
+                _uni.zmul = hmax;
+                }
+            else
+                { // w = 1/z in ]0, 1/near] is mapped to ]0, 2*hmax]
+                const float znear = _projM.M[14] / (_projM.M[10] - 1.0f);
+                _uni.zmul = (znear > 0) ? (2 * hmax * znear) : (2 * hmax);
+                }
+            }
+
+
+
+        /***********************************************************
+        * HIERARCHICAL ZBUFFER
+        ************************************************************/
+
+
+        /**
+        * enable the hierarchical zbuffer if it is large enough for the image. All its blocks are marked
+        * as dirty if reset is set or if the size (or stride) of the image changed since the last call.
+        **/
+        void _updateHiZbuffer(bool reset)
+            {
+            const float* prev = _uni.hiz;
+            _uni.hiz = nullptr;
+            if ((_hiz_buf == nullptr) || (_uni.im == nullptr) || (_uni.zbuf == nullptr)) return;
+            const int hlx = (_uni.im->lx() + 7) >> 3;
+            const int hly = (_uni.im->ly() + 7) >> 3;
+            if (hlx * hly > _hiz_len) return;
+            const iVec3 dim(_uni.im->lx(), _uni.im->ly(), _uni.im->stride());
+            if ((reset) || (prev == nullptr) || (dim != _hiz_dim))
+                {
+                for (int k = 0; k < hlx * hly; k++) _hiz_buf[k] = -1.0f;
+                _hiz_dim = dim;
+                }
+            _uni.hiz = _hiz_buf;
+            _uni.hiz_stride = hlx;
+            }
+
+
+
+        /***********************************************************
+        * BINNED RENDERING
+        ************************************************************/
+
+
+        /** send a triangle to the rasterizer (or store it in the triangle buffer when binning). */
+        TGX_INLINE void _rasterizeTriangle(const RasterizerVec4& V0, const RasterizerVec4& V1, const RasterizerVec4& V2)
+            {
+            const Image<color_t>* tex = _uni.tex;
+            if ((_mipmap) && (TGX_SHADER_HAS_TEXTURE(_uni.shader_type))) _uni.tex = _mipmapLevel(V0, V1, V2);
+            TGX_STAT(_stats.triangles_rasterized++);
+            if (_recording)
+                _recordTriangle(V0, V1, V2);
+            else if (((_bin_enabled) || (_deferred)) && (_bin_size > 0))
+                _binTriangle(V0, V1, V2);
+            else
+                {
+                int xmin, xmax, ymin, ymax;
+                _triangleBox(V0, V1, V2, xmin, xmax, ymin, ymax);
+                _markDirty(xmin, xmax, ymin, ymax);
+                rasterizeTriangle<LX, LY>(V0, V1, V2, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t, ZBUFFER_t>);
+                }
+            _uni.tex = tex;
+            }
+
+
+        /** bounding box of a triangle in the viewport (with a 1 pixel margin), may be empty if the triangle is outside the viewport. */
+        TGX_INLINE void _triangleBox(const fVec4& V0, const fVec4& V1, const fVec4& V2, int& xmin, int& xmax, int& ymin, int& ymax) const
+            {
+            const float hx = LX * 0.5f;
+            const float hy = LY * 0.5f;
+            xmin = max((int)floorf((min(min(V0.x, V1.x), V2.x) + 1.0f) * hx) - 1, 0);
+            xmax = min((int)floorf((max(max(V0.x, V1.x), V2.x) + 1.0f) * hx) + 1, LX - 1);
+            ymin = max((int)floorf((min(min(V0.y, V1.y), V2.y) + 1.0f) * hy) - 1, 0);
+            ymax = min((int)floorf((max(max(V0.y, V1.y), V2.y) + 1.0f) * hy) + 1, LY - 1);
+            }
+
+
+        /** add a box (in viewport coordinates) to the dirty region, if it intersects the image. */
+        TGX_INLINE void _markDirty(int xmin, int xmax, int ymin, int ymax)
+            {
+            if ((xmax < _ox) || (xmin >= _ox + _uni.im->lx()) || (ymax < _oy) || (ymin >= _oy + _uni.im->ly())) return;
+            _dirty.minX = min(_dirty.minX, xmin);
+            _dirty.maxX = max(_dirty.maxX, xmax);
+            _dirty.minY = min(_dirty.minY, ymin);
+            _dirty.maxY = max(_dirty.maxY, ymax);
+            }
+
+
+        /**
+        * Select the level of the mip chain to use for texturing a triangle: choose the
+        * largest level with at most 2 texels per pixel (in each direction) by comparing
+        * the area of the triangle in texture space (in texels of level 0) and on the screen
+        * (in pixels).
+        **/
+        const Image<color_t>* _mipmapLevel(const RasterizerVec4& V0, const RasterizerVec4& V1, const RasterizerVec4& V2) const
+            {
+            const Image<color_t>* L = _mipmap->level;
+            const float ta = fabsf(((V1.T.x - V0.T.x) * (V2.T.y - V0.T.y)) - ((V2.T.x - V0.T.x) * (V1.T.y - V0.T.y))) * (float)(L[0].lx() * L[0].ly());
+            const float pa = fabsf(((V1.x - V0.x) * (V2.y - V0.y)) - ((V2.x - V0.x) * (V1.y - V0.y))) * (LX * LY * 0.25f);
+            const float pa4 = 4 * pa;
+            float r = ta;
+            int l = 0;
+            while ((l < _mipmap->nb_levels - 1) && (r >= pa4)) { r *= 0.25f; l++; }
+            return L + l;
+            }
+
+
+        /**
+        * Minimum length of a buffer accessed with the same stride as the image (zbuffer and
+        * visibility buffer). The image must be valid.
+        **/
+        TGX_INLINE int _imageBufferLen() const
+            {
+            return ((_uni.im->ly() - 1) * _uni.im->stride()) + _uni.im->lx();
+            }
+
+
+        /** store a triangle in the triangle buffer, flush the buffer if it is full. */
+        void _binTriangle(const RasterizerVec4& V0, const RasterizerVec4& V1, const RasterizerVec4& V2)
+            {
+            int xmin, xmax, ymin, ymax;
+            _triangleBox(V0, V1, V2, xmin, xmax, ymin, ymax);
+            // discard triangles outside of the image.
+            if ((xmax < _ox) || (xmin >= _ox + _uni.im->lx()) || (ymax < _oy) || (ymin >= _oy + _uni.im->ly())) return;
+            _markDirty(xmin, xmax, ymin, ymax);
+            if (_bin_nb >= _bin_size) flush();
+            if (_bin_nb == 0) _tileListsReset(); // new batch
+            RasterizerTriangle<color_t>& T = _bin_buf[_bin_nb];
+            _storeTriangle(T, V0, V1, V2, xmin, xmax, ymin, ymax);
+            if ((_tl_valid) && (!_tileListsAdd(_bin_nb, T)))
+                { // the tile lists are full: draw the triangles already stored and start a new batch with this one.
+                flush();
+                _bin_buf[0] = T;
+                _tileListsReset();
+                _tileListsAdd(0, _bin_buf[0]);
+                }
+            _bin_nb++;
+            }
+
+
+        /** store a triangle in the display list being recorded. */
+        void _recordTriangle(const RasterizerVec4& V0, const RasterizerVec4& V1, const RasterizerVec4& V2)
+            {
+            int xmin, xmax, ymin, ymax;
+            _triangleBox(V0, V1, V2, xmin, xmax, ymin, ymax);
+            if ((xmax < xmin) || (ymax < ymin)) return; // outside of the viewport
+            if (_rec_nb >= _rec_size) { _rec_overflow = true; return; }
+            _storeTriangle(_rec_buf[_rec_nb++], V0, V1, V2, xmin, xmax, ymin, ymax);
+            }
+
+
+        /** save a triangle together with the current uniform parameters. */
+        TGX_INLINE void _storeTriangle(RasterizerTriangle<color_t>& T, const RasterizerVec4& V0, const RasterizerVec4& V1, const RasterizerVec4& V2, int xmin, int xmax, int ymin, int ymax)
+            {
+            T.V0 = V0;
+            T.V1 = V1;
+            T.V2 = V2;
+            T.facecolor = _uni.facecolor;
+            T.tex = _uni.tex;
+            T.shader_type = _uni.shader_type;
+            T.xmin = (int16_t)xmin;
+            T.xmax = (int16_t)xmax;
+            T.ymin = (int16_t)ymin;
+            T.ymax = (int16_t)ymax;
+            }
+
+
+        /**
+        * rasterize all the triangles of a list onto the image, tile by tile.
+        * Set binned if the tile lists were filled with the triangles of the list while binning them.
+        **/
+        int _flushTriangles(const RasterizerTriangle<color_t>* tris, int nb, bool binned = false);
+
+
+        static const uint32_t _TL_NIL = 0xFFFFFFFF; // end of a tile list
+
+
+        /** number of tiles for the current image and tile size. */
+        TGX_INLINE void _tileCount(int& nbtx, int& nbty) const
+            {
+            nbtx = (_uni.im->lx() + _bin_tlx - 1) / _bin_tlx;
+            nbty = (_uni.im->ly() + _bin_tly - 1) / _bin_tly;
+            }
+
+
+        /**
+        * Empty the tile lists and set them up for the current image, offset and tile size.
+        * Return false (and disable the lists) if there is no tile list buffer or if it is too small.
+        **/
+        bool _tileListsReset()
+            {
+            _tl_valid = false;
+            if ((_tl_buf == nullptr) || (_uni.im == nullptr) || (!_uni.im->isValid())) return false;
+            int nbtx, nbty;
+            _tileCount(nbtx, nbty);
+            const int nbtiles = nbtx * nbty;
+            _tl_nodes = (_tl_len / 2) - nbtiles;
+            if (_tl_nodes < nbtiles) return false; // the lists must at least hold a triangle covering every tile
+            for (int t = 0; t < 2 * nbtiles; t++) _tl_buf[t] = _TL_NIL;
+            _tl_used = 0;
+            _tl_nbtx = nbtx;
+            _tl_nbtiles = nbtiles;
+            _tl_area = iBox2(_ox, _ox + _uni.im->lx() - 1, _oy, _oy + _uni.im->ly() - 1);
+            _tl_tile = iVec2(_bin_tlx, _bin_tly);
+            _tl_valid = true;
+            return true;
+            }
+
+
+        /** true if the tile lists were set up for the current image, offset and tile size. */
+        bool _tileListsMatch() const
+            {
+            return ((_tl_valid) && (_tl_area == iBox2(_ox, _ox + _uni.im->lx() - 1, _oy, _oy + _uni.im->ly() - 1)) && (_tl_tile == iVec2(_bin_tlx, _bin_tly)));
+            }
+
+
+        /**
+        * Append triangle number k to the lists of the tiles it overlaps.
+        * Return false (and add nothing) if there is not enough room left.
+        **/
+        bool _tileListsAdd(const int k, const RasterizerTriangle<color_t>& T)
+            {
+            const int x0 = max((int)T.xmin, _tl_area.minX) - _tl_area.minX;
+            const int x1 = min((int)T.xmax, _tl_area.maxX) - _tl_area.minX;
+            const int y0 = max((int)T.ymin, _tl_area.minY) - _tl_area.minY;
+            const int y1 = min((int)T.ymax, _tl_area.maxY) - _tl_area.minY;
+            if ((x0 > x1) || (y0 > y1)) return true; // outside of the image
+            const int tx0 = x0 / _tl_tile.x;
+            const int tx1 = x1 / _tl_tile.x;
+            const int ty0 = y0 / _tl_tile.y;
+            const int ty1 = y1 / _tl_tile.y;
+            if (_tl_used + ((tx1 - tx0 + 1) * (ty1 - ty0 + 1)) > _tl_nodes) return false;
+            uint32_t* nodes = _tl_buf + 2 * _tl_nbtiles;
+            for (int ty = ty0; ty <= ty1; ty++)
+                {
+                for (int tx = tx0; tx <= tx1; tx++)
+                    {
+                    uint32_t* L = _tl_buf + 2 * (tx + ty * _tl_nbtx);
+                    const uint32_t n = (uint32_t)(_tl_used++);
+                    nodes[2 * n] = (uint32_t)k;
+                    nodes[2 * n + 1] = _TL_NIL;
+                    if (L[1] == _TL_NIL) L[0] = n; else nodes[2 * L[1] + 1] = n;
+                    L[1] = n;
+                    }
+                }
+            return true;
+            }
+
+
+        /** call fun(k) for each triangle tris[k], start <= k < end, overlapping tile number t (whose box in viewport coordinates is V). */
+        template<typename FUN> TGX_INLINE void _forEachTileTriangle(const int t, const iBox2& V, const RasterizerTriangle<color_t>* tris, const int start, const int end, const bool lists, FUN fun)
+            {
+            if (lists)
+                {
+                const uint32_t* nodes = _tl_buf + 2 * _tl_nbtiles;
+                for (uint32_t n = _tl_buf[2 * t]; n != _TL_NIL; n = nodes[2 * n + 1]) fun((int)nodes[2 * n]);
+                return;
+                }
+            for (int k = start; k < end; k++)
+                {
+                const RasterizerTriangle<color_t>& T = tris[k];
+                if ((T.xmax < V.minX) || (T.xmin > V.maxX) || (T.ymax < V.minY) || (T.ymin > V.maxY)) continue; // not in this tile
+                fun(k);
+                }
+            }
+
+
+        /**
+        * rasterize the triangles tris[start..end[ overlapping tile number t whose box (in image coordinates) is B.
+        * The triangles are taken from the tile lists when lists is set.
+        * uni is a copy of _uni owned by the calling thread (and updated for the tile).
+        **/
+        void _rasterizeTile(const int t, const iBox2& B, const bool deferred, const RasterizerTriangle<color_t>* tris, const int start, const int end, const bool lists, RasterizerParams<color_t, color_t, ZBUFFER_t>& uni)
+            {
+            TGX_TRACE_SCOPE("Renderer3D::_rasterizeTile");
+            Image<color_t> im(*_uni.im, B, true);
+            if (!im.isValid()) return;
+            uni.im = &im;
+            if (ZBUFFER) uni.zbuf = _uni.zbuf + B.minX + (B.minY * _uni.im->stride());
+            if (_uni.hiz) uni.hiz = _uni.hiz + (B.minX >> 3) + ((B.minY >> 3) * _uni.hiz_stride); // tiles are aligned on 8x8 blocks
+            const int ox = _ox + B.minX;
+            const int oy = _oy + B.minY;
+            const iBox2 V(ox, ox + im.lx() - 1, oy, oy + im.ly() - 1); // tile in viewport coordinates
+            if (deferred)
+                { // visibility pass followed by the resolve pass
+                const int stride = _uni.im->stride();
+                uni.vbuf = _vis_buf + B.minX + (B.minY * stride);
+                for (int j = 0; j < im.ly(); j++) memset(uni.vbuf + (j * stride), 0, im.lx() * sizeof(uint32_t));
+                _forEachTileTriangle(t, V, tris, start, end, lists, [&](int k)
+                    {
+                    const RasterizerTriangle<color_t>& T = tris[k];
+                    uni.vid = (uint32_t)(k + 1);
+                    rasterizeTriangle<LX, LY>(T.V0, T.V1, T.V2, ox, oy, uni, shader_Visibility_Zbuffer<color_t, ZBUFFER_t>);
+                    });
+                _resolveTile(im, uni.vbuf, ox, oy, tris);
+                return;
+                }
+            _forEachTileTriangle(t, V, tris, start, end, lists, [&](int k)
+                {
+                const RasterizerTriangle<color_t>& T = tris[k];
+                uni.shader_type = T.shader_type;
+                uni.facecolor = T.facecolor;
+                uni.tex = T.tex;
+                rasterizeTriangle<LX, LY>(T.V0, T.V1, T.V2, ox, oy, uni, shader_select<ZBUFFER, ORTHO, color_t, ZBUFFER_t>);
+                });
+            }
+
+
+        /** resolve pass of deferred rendering: shade each pixel of a tile using the triangle in the visibility buffer. */
+        void _resolveTile(Image<color_t>& im, const uint32_t* vbuf, const int ox, const int oy, const RasterizerTriangle<color_t>* tris)
+            {
+            const int stride = im.stride();
+            const float hx = LX * 0.5f;
+            const float hy = LY * 0.5f;
+            const bool bilinear = _uni.use_bilinear_texturing;
+            const bool tiled = _uni.use_tiled_textures;
+            uint32_t cur = 0;
+            const RasterizerTriangle<color_t>* T = nullptr;
+            float a1 = 0, b1 = 0, c1 = 0, a2 = 0, b2 = 0, c2 = 0; // barycentric coords. l1 = a1*x + b1*y + c1 and l2 = a2*x + b2*y + c2
+            for (int j = 0; j < im.ly(); j++)
+                {
+                color_t* buf = im.data() + (j * stride);
+                const uint32_t* vb = vbuf + (j * stride);
+                const float py = oy + j + 0.5f;
+                for (int i = 0; i < im.lx(); i++)
+                    {
+                    const uint32_t id = vb[i];
+                    if (id == 0) continue; // no triangle here
+                    if (id != cur)
+                        { // new triangle: compute the barycentric coordinates
+                        cur = id;
+                        T = tris + (id - 1);
+                        const float x0 = (T->V0.x + 1.0f) * hx, y0 = (T->V0.y + 1.0f) * hy;
+                        const float x1 = (T->V1.x + 1.0f) * hx, y1 = (T->V1.y + 1.0f) * hy;
+                        const float x2 = (T->V2.x + 1.0f) * hx, y2 = (T->V2.y + 1.0f) * hy;
+                        const float ia = 1.0f / (((x1 - x0) * (y2 - y0)) - ((x2 - x0) * (y1 - y0)));
+                        a1 = (y2 - y0) * ia; b1 = (x0 - x2) * ia; c1 = -(x0 * a1 + y0 * b1);
+                        a2 = (y0 - y1) * ia; b2 = (x1 - x0) * ia; c2 = -(x0 * a2 + y0 * b2);
+                        }
+                    const float px = ox + i + 0.5f;
+                    const float l1 = (a1 * px) + (b1 * py) + c1;
+                    const float l2 = (a2 * px) + (b2 * py) + c2;
+                    const float l0 = 1.0f - l1 - l2;
+                    const int shader = T->shader_type;
+                    if (TGX_SHADER_HAS_TEXTURE(shader))
+                        {
+                        // perspective correct texture coords.
+                        const float q0 = (ORTHO) ? l0 : (l0 * T->V0.w);
+                        const float q1 = (ORTHO) ? l1 : (l1 * T->V1.w);
+                        const float q2 = (ORTHO) ? l2 : (l2 * T->V2.w);
+                        const float iq = 1.0f / (q0 + q1 + q2);
+                        const Image<color_t>& tex = *(T->tex);
+                        const int32_t texsize_x = tex.width() - 1;
+                        const int32_t texsize_y = tex.height() - 1;
+                        const int32_t texstride = tex.stride();
+                        const float xx = ((q0 * T->V0.T.x) + (q1 * T->V1.T.x) + (q2 * T->V2.T.x)) * iq * texsize_x;
+                        const float yy = ((q0 * T->V0.T.y) + (q1 * T->V1.T.y) + (q2 * T->V2.T.y)) * iq * texsize_y;
+                        color_t col;
+                        if (bilinear)
+                            {
+                            const int ttx = (int)floorf(xx);
+                            const int tty = (int)floorf(yy);
+                            const float ax = xx - ttx;
+                            const float ay = yy - tty;
+                            const int minx = ttx & (texsize_x);
+                            const int maxx = (ttx + 1) & (texsize_x);
+                            const int miny = tty & (texsize_y);
+                            const int maxy = (tty + 1) & (texsize_y);
+                            const color_t* t = tex.data();
+                            if (tiled)
+                                col = blend_bilinear(t[texelIndex<true>(minx, miny, texstride)], t[texelIndex<true>(maxx, miny, texstride)], t[texelIndex<true>(minx, maxy, texstride)], t[texelIndex<true>(maxx, maxy, texstride)], ax, ay);
+                            else
+                                col = blend_bilinear(t[texelIndex<false>(minx, miny, texstride)], t[texelIndex<false>(maxx, miny, texstride)], t[texelIndex<false>(minx, maxy, texstride)], t[texelIndex<false>(maxx, maxy, texstride)], ax, ay);
+                            }
+                        else
+                            {
+                            const int tx = ((int)xx) & texsize_x;
+                            const int ty = ((int)yy) & texsize_y;
+                            col = tex.data()[(tiled) ? texelIndex<true>(tx, ty, texstride) : texelIndex<false>(tx, ty, texstride)];
+                            }
+                        if (TGX_SHADER_HAS_GOURAUD(shader))
+                            col.mult256((int)(256 * ((l0 * T->V0.color.R) + (l1 * T->V1.color.R) + (l2 * T->V2.color.R))),
+                                        (int)(256 * ((l0 * T->V0.color.G) + (l1 * T->V1.color.G) + (l2 * T->V2.color.G))),
+                                        (int)(256 * ((l0 * T->V0.color.B) + (l1 * T->V1.color.B) + (l2 * T->V2.color.B))));
+                        else
+                            col.mult256((int)(256 * T->facecolor.R), (int)(256 * T->facecolor.G), (int)(256 * T->facecolor.B));
+                        buf[i] = col;
+                        }
+                    else if (TGX_SHADER_HAS_GOURAUD(shader))
+                        {
+                        buf[i] = (color_t)RGBf((l0 * T->V0.color.R) + (l1 * T->V1.color.R) + (l2 * T->V2.color.R),
+                                               (l0 * T->V0.color.G) + (l1 * T->V1.color.G) + (l2 * T->V2.color.G),
+                                               (l0 * T->V0.color.B) + (l1 * T->V1.color.B) + (l2 * T->V2.color.B));
+                        }
+                    else
+                        {
+                        buf[i] = (color_t)T->facecolor;
+                        }
+                    }
+                }
+            }
+
+
+
         /***********************************************************
         * CLIPPING
         ************************************************************/
@@ -1457,18 +2790,32 @@ namespace tgx
             }
 
 
+        /** bounds of the image in normalized device coordinates (with a 1 pixel margin) used for discarding objects. */
+        void _frustumBounds(float & bx, float & Bx, float & by, float & By) const
+            {
+            // test against the image (or against the whole viewport when recording a display list)
+            const int ox = (_recording) ? 0 : _ox;
+            const int oy = (_recording) ? 0 : _oy;
+            const int lx = (_recording) ? LX : _uni.im->width();
+            const int ly = (_recording) ? LY : _uni.im->height();
+            const float ilx = 2.0f / LX;
+            bx = (ox - 1) * ilx - 1.0f;
+            Bx = (ox + lx + 1) * ilx - 1.0f;
+            const float ily = 2.0f / LY;
+            by = (oy - 1) * ily - 1.0f;
+            By = (oy + ly + 1) * ily - 1.0f;
+            }
+
+
         /* test if a box is outside the image and should be discarded. */
         bool _discard(const fBox3 & bb, const fMat4& M)
             {
+            TGX_TRACE_SCOPE("Renderer3D::_discard");
             if ((bb.minX == 0) && (bb.maxX == 0) && (bb.minY == 0) && (bb.maxY == 0) && (bb.minZ == 0) && (bb.maxZ == 0))
                 return false; // do not discard if the bounding box is uninitialized.
 
-            const float ilx = 2.0f / LX;
-            const float bx = (_ox - 1) * ilx - 1.0f;
-            const float Bx = (_ox + _uni.im->width() + 1) * ilx - 1.0f;
-            const float ily = 2.0f / LY;
-            const float by = (_oy - 1) * ily - 1.0f;
-            const float By = (_oy + _uni.im->height() + 1) * ily - 1.0f;
+            float bx, Bx, by, By;
+            _frustumBounds(bx, Bx, by, By);
 
             int fl = 63; // every bit set
             _clip(fl, fVec3(bb.minX, bb.minY, bb.minZ), M, bx, Bx, by, By);
@@ -1509,6 +2856,7 @@ namespace tgx
         /** test if the mesh may possibly need clipping. If it return false, then cliptest can be skipped. */
         bool _clipTestNeeded(float clipboundXY, const fBox3 & bb, const fMat4 & M)
             {
+            TGX_TRACE_SCOPE("Renderer3D::_clipTestNeeded");
             return (_clip2(clipboundXY, fVec3(bb.minX, bb.minY, bb.minZ), M)
                  || _clip2(clipboundXY, fVec3(bb.minX, bb.minY, bb.maxZ), M)
                  || _clip2(clipboundXY, fVec3(bb.minX, bb.maxY, bb.minZ), M)
@@ -1520,6 +2868,131 @@ namespace tgx
             }
 
 
+        /** state used by _cullClusters() while iterating over the face array of a mesh */
+        struct _ClusterCulling
+            {
+            const uint16_t* face;           // start of the face array of the mesh
+            const Mesh3DCluster* cl;        // next cluster
+            const Mesh3DCluster* end;       // end of the cluster array
+            fVec4 plane[6];                 // frustum planes in model space (normalized, positive inside): left, right, bottom, top, near, far
+            fVec4 guard[4];                 // planes of the guard band (outside of which triangles must be clipped): left, right, bottom, top
+            fVec3 cam;                      // camera position (perspective) or view direction (ortho) in model space
+            float sgn;                      // orientation of the cone axes w.r.t. culled faces (0 to disable normal cone culling)
+            bool cliptestneeded;            // true if the clipping test is needed for the whole mesh
+            };
+
+
+        /**
+        * Prepare the culling of the clusters of a mesh: the frustum and guard band planes are computed
+        * in model space so that a bounding sphere is tested with one dot product per plane. Normal cone
+        * culling is only used when back face culling is enabled and the model-view matrix is a
+        * similarity (rotation, translation, uniform scaling, possibly with a reflection) because other
+        * transformations do not preserve the cones.
+        **/
+        void _initClusterCulling(_ClusterCulling& cc, const Mesh3D<color_t>* mesh, const bool cliptestneeded)
+            {
+            cc.face = mesh->face;
+            cc.cl = ((mesh->cluster) && (mesh->nb_clusters > 0)) ? mesh->cluster : nullptr;
+            cc.end = (cc.cl) ? (mesh->cluster + mesh->nb_clusters) : nullptr;
+            cc.cliptestneeded = cliptestneeded;
+            cc.sgn = 0;
+            if (cc.cl == nullptr) return;
+            // a point P is inside the frustum when the clip coordinates S = M.P satisfy bx.w <= x <= Bx.w,
+            // by.w <= y <= By.w and -w <= z <= w: each inequality is a plane in model space.
+            static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
+            const fMat4 M = _projM * _r_modelViewM;
+            const float* R = M.M;
+            const fVec4 X(R[0], R[4], R[8], R[12]), Y(R[1], R[5], R[9], R[13]), Z(R[2], R[6], R[10], R[14]), W(R[3], R[7], R[11], R[15]);
+            float bx, Bx, by, By;
+            _frustumBounds(bx, Bx, by, By);
+            cc.plane[0] = _normalizePlane(X - (W * bx));
+            cc.plane[1] = _normalizePlane((W * Bx) - X);
+            cc.plane[2] = _normalizePlane(Y - (W * by));
+            cc.plane[3] = _normalizePlane((W * By) - Y);
+            cc.plane[4] = _normalizePlane(W + Z);
+            cc.plane[5] = _normalizePlane(W - Z);
+            cc.guard[0] = _normalizePlane(X + (W * clipboundXY));
+            cc.guard[1] = _normalizePlane((W * clipboundXY) - X);
+            cc.guard[2] = _normalizePlane(Y + (W * clipboundXY));
+            cc.guard[3] = _normalizePlane((W * clipboundXY) - Y);
+            if (_culling_dir == 0) return;
+            const float* A = _r_modelViewM.M;
+            const fVec3 C0(A[0], A[1], A[2]), C1(A[4], A[5], A[6]), C2(A[8], A[9], A[10]);
+            const float s2 = C0.norm2();
+            const float eps = s2 * 0.001f;
+            if ((s2 <= 0) || (fabsf(C1.norm2() - s2) > eps) || (fabsf(C2.norm2() - s2) > eps)
+             || (fabsf(dotProduct(C0, C1)) > eps) || (fabsf(dotProduct(C0, C2)) > eps) || (fabsf(dotProduct(C1, C2)) > eps)) return; // not a similarity
+            cc.sgn = (dotProduct(crossProduct(C0, C1), C2) > 0) ? _culling_dir : -_culling_dir; // a reflection reverses the winding order
+            if (ORTHO)
+                { // view direction (0,0,-1) in model space
+                cc.cam = fVec3(-A[2], -A[6], -A[10]) / sqrtf(s2);
+                }
+            else
+                { // camera position (origin of the view space) in model space
+                const fVec3 T(A[12], A[13], A[14]);
+                cc.cam = fVec3(-dotProduct(C0, T), -dotProduct(C1, T), -dotProduct(C2, T)) / s2;
+                }
+            }
+
+
+        /** normalize a plane (a,b,c,d) so that ax + by + cz + d is the signed distance to the plane. */
+        static fVec4 _normalizePlane(const fVec4 & P)
+            {
+            const float l = sqrtf(P.x * P.x + P.y * P.y + P.z * P.z);
+            return (l > 0) ? (P / l) : fVec4(0, 0, 0, 1); // degenerate plane: everything is inside
+            }
+
+
+        /** signed distance from a plane (normalized) to a point */
+        static TGX_INLINE float _planeDist(const fVec4 & P, const fVec3 & V)
+            {
+            return P.x * V.x + P.y * V.y + P.z * V.z + P.w;
+            }
+
+
+        /**
+        * Called at the start of each chain. Skip the clusters starting at 'face' that are outside of
+        * the view frustum or whose triangles all face away from the camera and set cliptestneeded for
+        * the next cluster drawn. Return the new position in the face array.
+        **/
+        const uint16_t* _cullClusters(_ClusterCulling& cc, const uint16_t* face, bool& cliptestneeded)
+            {
+            while ((cc.cl != cc.end) && (face == cc.face + cc.cl->face_start))
+                {
+                const Mesh3DCluster& C = *(cc.cl++);
+                if ((cc.sgn != 0) && (C.cone_cutoff < 1.0f))
+                    { // normal cone test: all faces point away from the camera ?
+                    const fVec3 axis = C.cone_axis * cc.sgn;
+                    bool culled;
+                    if (ORTHO)
+                        {
+                        culled = (dotProduct(cc.cam, axis) > C.cone_cutoff);
+                        }
+                    else
+                        {
+                        const fVec3 V = C.center - cc.cam;
+                        culled = (dotProduct(V, axis) > C.cone_cutoff * V.norm() + C.radius * (1.0f + C.cone_cutoff));
+                        }
+                    if (culled) { TGX_STAT(_stats.triangles_backface += C.nb_faces); face = cc.face + C.face_end; continue; }
+                    }
+                // bounding sphere against the frustum planes
+                const float d4 = _planeDist(cc.plane[4], C.center);
+                const float d5 = _planeDist(cc.plane[5], C.center);
+                if ((d4 < -C.radius) || (d5 < -C.radius)
+                 || (_planeDist(cc.plane[0], C.center) < -C.radius) || (_planeDist(cc.plane[1], C.center) < -C.radius)
+                 || (_planeDist(cc.plane[2], C.center) < -C.radius) || (_planeDist(cc.plane[3], C.center) < -C.radius))
+                    {
+                    TGX_STAT(_stats.triangles_discarded += C.nb_faces); face = cc.face + C.face_end; continue;
+                    }
+                // clipping is needed if the sphere is not inside the guard band and the near/far planes.
+                cliptestneeded = (cc.cliptestneeded) && ((d4 <= C.radius) || (d5 <= C.radius)
+                    || (_planeDist(cc.guard[0], C.center) <= C.radius) || (_planeDist(cc.guard[1], C.center) <= C.radius)
+                    || (_planeDist(cc.guard[2], C.center) <= C.radius) || (_planeDist(cc.guard[3], C.center) <= C.radius));
+                }
+            return face;
+            }
+
+
 
 
         /***********************************************************
@@ -1601,11 +3074,56 @@ namespace tgx
         fMat4   _projM;             // projection matrix
 
         int     _zbuffer_len;       // size of the zbuffer
+        float*  _hiz_buf;           // hierarchical zbuffer
+        int     _hiz_len;           // size of the hierarchical zbuffer
+        iVec3   _hiz_dim;           // width, height and stride of the image for which the hierarchical zbuffer was set up
+        iBox2   _dirty;             // dirty region (in viewport coordinates)
+#if TGX_RENDERER_STATS
+        RendererStats _stats;       // triangle counters (the pixel counters are in _uni)
+#endif
         
-        RasterizerParams<color_t, color_t>  _uni; // rasterizer param (contain the image pointer and the zbuffer pointer).
+        RasterizerParams<color_t, color_t, ZBUFFER_t>  _uni; // rasterizer param (contain the image pointer and the zbuffer pointer).
 
         float _culling_dir;         // culling direction postive/negative or 0 to disable back face culling.
 
+        RasterizerTriangle<color_t>* _bin_buf;  // triangle buffer used for binned rendering
+        int     _bin_size;          // size of the triangle buffer
+        int     _bin_nb;            // number of triangles currently in the buffer
+        bool    _bin_enabled;       // true if binned rendering is enabled
+        int     _bin_tlx, _bin_tly; // tile size
+        int     _bin_threads;       // number of threads used for rasterization (0 = hardware concurrency)
+
+        uint32_t* _tl_buf;          // tile lists: head and tail of the list of each tile followed by the nodes (triangle index, next node)
+        int     _tl_len;            // size of the tile list buffer
+        int     _tl_nodes;          // number of nodes available
+        int     _tl_used;           // number of nodes used
+        int     _tl_nbtx;           // number of tiles per row
+        int     _tl_nbtiles;        // number of tiles
+        iBox2   _tl_area;           // image (in viewport coordinates) for which the lists were built
+        iVec2   _tl_tile;           // tile size for which the lists were built
+        bool    _tl_valid;          // true if the lists hold the triangles of the triangle buffer
+#if TGX_MULTITHREAD
+        _TileWorkers _workers;      // worker threads used by flush()
+#endif
+
+        uint32_t* _vis_buf;         // visibility buffer for deferred rendering
+        int     _vis_len;           // size of the visibility buffer
+        bool    _deferred;          // true if deferred rendering is enabled
+
+        RasterizerTriangle<color_t>* _rec_buf;  // buffer of the display list being recorded
+        int     _rec_size;          // size of the display list buffer
+        int     _rec_nb;            // number of triangles recorded
+        bool    _rec_overflow;      // true if some triangles could not be recorded
+        bool    _recording;         // true while recording a display list
+
+        const Mipmap<color_t>* _mipmap; // mip chain of the texture of the mesh being drawn (nullptr if none)
+
+        float   _lod_density;       // max number of triangles per pixel of projected bounding box when selecting the LOD
+
+        void*    _vcache_buf;       // post-transform vertex cache (nullptr if not used)
+        int      _vcache_len;       // size of the vertex cache in bytes
+        uint32_t _vcache_stamp;     // stamp of the current drawMesh() call: entries with a different stamp are stale
+
 
         // *** scene parameters ***
 
@@ -1677,8 +3195,13 @@ namespace tgx
 
 
 
-        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
-        Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::Renderer3D() : _currentpow(-1), _ox(0), _oy(0), _zbuffer_len(0), _uni(), _culling_dir(1)
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::Renderer3D() : _currentpow(-1), _ox(0), _oy(0), _zbuffer_len(0), _hiz_buf(nullptr), _hiz_len(0), _hiz_dim(0, 0, 0), _dirty(LX, -1, LY, -1), _uni(), _culling_dir(1),
+                                                                    _bin_buf(nullptr), _bin_size(0), _bin_nb(0), _bin_enabled(false), _bin_tlx(128), _bin_tly(64), _bin_threads(0),
+                                                                    _tl_buf(nullptr), _tl_len(0), _tl_nodes(0), _tl_used(0), _tl_nbtx(0), _tl_nbtiles(0), _tl_area(0, -1, 0, -1), _tl_tile(0, 0), _tl_valid(false),
+                                                                    _vis_buf(nullptr), _vis_len(0), _deferred(false),
+                                                                    _rec_buf(nullptr), _rec_size(0), _rec_nb(0), _rec_overflow(false), _recording(false), _mipmap(nullptr), _lod_density(0.5f),
+                                                                    _vcache_buf(nullptr), _vcache_len(0), _vcache_stamp(0)
             {
             _uni.im = nullptr;
             _uni.tex = nullptr; 
@@ -1686,6 +3209,17 @@ namespace tgx
             _uni.zbuf = 0; 
             _uni.facecolor = RGBf(1.0, 1.0, 1.0);
             _uni.use_bilinear_texturing = false;
+            _uni.use_tiled_textures = false;
+            _uni.tex_subspan = 0;
+            _uni.tex_subspan_maxerr = 0.5f;
+            _uni.hiz = nullptr;
+            _uni.hiz_stride = 0;
+            _uni.zmul = 1.0f;
+            _uni.zoff = 0.0f;
+            _uni.zepoch = 0;
+            resetStats();
+            _uni.vbuf = nullptr;
+            _uni.vid = 0;
 
             // let's set some default values
             fMat4 M;
@@ -1709,62 +3243,312 @@ namespace tgx
 
 
 
-        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
-        int  Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::drawMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material, bool draw_chained_meshes)
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int  Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::drawMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material, bool draw_chained_meshes, bool sort_front_to_back)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly() ))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
 
-            while (mesh)
+            if ((sort_front_to_back) && (draw_chained_meshes))
+                {
+                const Mesh3D<color_t>* tab[TGX_RENDERER3D_MAX_SORTED_MESHES];
+                float depth[TGX_RENDERER3D_MAX_SORTED_MESHES];
+                int ind[TGX_RENDERER3D_MAX_SORTED_MESHES];
+                while (mesh)
+                    { // sort and draw the chain by groups of at most TGX_RENDERER3D_MAX_SORTED_MESHES meshes
+                    int nb = 0;
+                    while ((mesh) && (nb < TGX_RENDERER3D_MAX_SORTED_MESHES))
+                        {
+                        if (MeshReader<color_t>(mesh).hasVertices())
+                            {
+                            tab[nb] = mesh;
+                            depth[nb] = _meshDepth(mesh);
+                            ind[nb] = nb;
+                            nb++;
+                            }
+                        mesh = mesh->next;
+                        }
+                    _sortByDepth(nb, depth, ind);
+                    for (int i = 0; i < nb; i++) _drawSingleMesh(shader, tab[ind[i]], use_mesh_material);
+                    }
+                }
+            else
                 {
-                if (mesh->vertice)
+                while (mesh)
                     {
-                    if (use_mesh_material)
-                        {   // use mesh material if requested
-                        _r_ambiantColor = _ambiantColor * mesh->ambiant_strength;
-                        _r_diffuseColor = _diffuseColor * mesh->diffuse_strength;
-                        _r_specularColor = _specularColor * mesh->specular_strength;
-                        _r_objectColor = mesh->color;
+                    _drawSingleMesh(shader, mesh, use_mesh_material);
+                    mesh = ((draw_chained_meshes) ? mesh->next : nullptr);
+                    }
+                }
+
+            if (use_mesh_material)
+                { // restore material pre-computed values
+                _r_ambiantColor = _ambiantColor * _ambiantStrength;
+                _r_diffuseColor = _diffuseColor * _diffuseStrength;
+                _r_specularColor = _specularColor * _specularStrength;
+                _r_objectColor = _color;
+                }
+            return 0;
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int  Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::drawMeshes(const int shader, int nb_meshes, const Mesh3D<color_t>* const* meshes, const fMat4* model_matrices, bool use_mesh_material, bool draw_chained_meshes)
+            {
+            if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
+            if ((meshes == nullptr) || (nb_meshes <= 0)) return 0;
+
+            const fMat4 saveM = _modelM;
+            float depth[TGX_RENDERER3D_MAX_SORTED_MESHES];
+            int ind[TGX_RENDERER3D_MAX_SORTED_MESHES];
+            for (int start = 0; start < nb_meshes; start += TGX_RENDERER3D_MAX_SORTED_MESHES)
+                { // sort and draw the meshes by groups of at most TGX_RENDERER3D_MAX_SORTED_MESHES
+                const int end = min(nb_meshes, start + TGX_RENDERER3D_MAX_SORTED_MESHES);
+                int nb = 0;
+                for (int i = start; i < end; i++)
+                    {
+                    if ((meshes[i] == nullptr) || (!MeshReader<color_t>(meshes[i]).hasVertices())) continue;
+                    if (model_matrices) setModelMatrix(model_matrices[i]);
+                    depth[nb] = _meshDepth(meshes[i]);
+                    ind[nb] = i;
+                    nb++;
+                    }
+                _sortByDepth(nb, depth, ind);
+                for (int i = 0; i < nb; i++)
+                    {
+                    if (model_matrices) setModelMatrix(model_matrices[ind[i]]);
+                    const Mesh3D<color_t>* mesh = meshes[ind[i]];
+                    while (mesh)
+                        {
+                        _drawSingleMesh(shader, mesh, use_mesh_material);
+                        mesh = ((draw_chained_meshes) ? mesh->next : nullptr);
                         }
-                    // precompute pow(.,specularExponent) table if needed
-                    const int specularExpo = (use_mesh_material ? mesh->specular_exponent : _specularExponent);
-                    _precomputeSpecularTable(specularExpo);
-                    int raster_type = shader;
-                    if (mesh->normal == nullptr) TGX_SHADER_REMOVE_GOURAUD(raster_type) // gouraud shading not available so we disable it
-                    if ((mesh->texcoord == nullptr) || (mesh->texture == nullptr)) TGX_SHADER_REMOVE_TEXTURE(raster_type) // texturing not available so we disable it
-                    if (TGX_SHADER_HAS_GOURAUD(raster_type))
+                    }
+                }
+            if (model_matrices) setModelMatrix(saveM);
+
+            if (use_mesh_material)
+                { // restore material pre-computed values
+                _r_ambiantColor = _ambiantColor * _ambiantStrength;
+                _r_diffuseColor = _diffuseColor * _diffuseStrength;
+                _r_specularColor = _specularColor * _specularStrength;
+                _r_objectColor = _color;
+                }
+            return 0;
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::_drawSingleMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material)
+            {
+            if (!MeshReader<color_t>(mesh).hasVertices()) return;
+            mesh = _selectLOD(mesh);
+            _drawMeshRaster(_setupMesh(shader, mesh, use_mesh_material), mesh);
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::_setupMesh(const int shader, const Mesh3D<color_t>* mesh, bool use_mesh_material)
+            {
+            TGX_TRACE_SCOPE("drawMesh: material setup");
+            if (use_mesh_material)
+                {   // use mesh material if requested
+                _r_ambiantColor = _ambiantColor * mesh->ambiant_strength;
+                _r_diffuseColor = _diffuseColor * mesh->diffuse_strength;
+                _r_specularColor = _specularColor * mesh->specular_strength;
+                _r_objectColor = mesh->color;
+                }
+            // precompute pow(.,specularExponent) table if needed
+            const int specularExpo = (use_mesh_material ? mesh->specular_exponent : _specularExponent);
+            _precomputeSpecularTable(specularExpo);
+            int raster_type = shader;
+            const MeshReader<color_t> reader(mesh);
+            if (!reader.hasNormals()) TGX_SHADER_REMOVE_GOURAUD(raster_type) // gouraud shading not available so we disable it
+            if ((!reader.hasTexcoords()) || (mesh->texture == nullptr)) TGX_SHADER_REMOVE_TEXTURE(raster_type) // texturing not available so we disable it
+            return raster_type;
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::_drawMeshRaster(const int raster_type, const Mesh3D<color_t>* mesh)
+            {
+            // use the mip chain of the texture (if any)
+            _mipmap = ((TGX_SHADER_HAS_TEXTURE(raster_type)) && (mesh->mipmap) && (mesh->mipmap->nb_levels > 0) && (!_uni.use_tiled_textures)) ? mesh->mipmap : nullptr;
+            if (TGX_SHADER_HAS_GOURAUD(raster_type))
+                {
+                if (TGX_SHADER_HAS_TEXTURE(raster_type))
+                    _drawMesh<TGX_SHADER_GOURAUD | TGX_SHADER_TEXTURE>(mesh);
+                else
+                    _drawMesh<TGX_SHADER_GOURAUD>(mesh);
+                }
+            else
+                {
+                if (TGX_SHADER_HAS_TEXTURE(raster_type))
+                    _drawMesh<TGX_SHADER_FLAT | TGX_SHADER_TEXTURE>(mesh);
+                else
+                    _drawMesh<TGX_SHADER_FLAT>(mesh);
+                }
+            _mipmap = nullptr;
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int  Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::drawMeshInstanced(const int shader, const Mesh3D<color_t>* mesh, const fMat4* models, int count, const RGBf* colors, bool use_mesh_material, bool draw_chained_meshes)
+            {
+            if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
+            if ((mesh == nullptr) || (models == nullptr) || (count <= 0)) return 0;
+
+            // bounding box of the whole object used for culling the instances
+            fBox3 bb = mesh->bounding_box;
+            bool cull = !((bb.minX == 0) && (bb.maxX == 0) && (bb.minY == 0) && (bb.maxY == 0) && (bb.minZ == 0) && (bb.maxZ == 0));
+            if (draw_chained_meshes)
+                {
+                for (const Mesh3D<color_t>* m = mesh->next; m != nullptr; m = m->next)
+                    {
+                    const fBox3& b = m->bounding_box;
+                    if ((b.minX == 0) && (b.maxX == 0) && (b.minY == 0) && (b.maxY == 0) && (b.minZ == 0) && (b.maxZ == 0)) cull = false;
+                    bb |= b;
+                    }
+                }
+            const fVec3 center = bb.center();
+
+            const fMat4 saveM = _modelM;
+            float depth[TGX_RENDERER3D_MAX_SORTED_MESHES];
+            int ind[TGX_RENDERER3D_MAX_SORTED_MESHES];
+            for (int start = 0; start < count; start += TGX_RENDERER3D_MAX_SORTED_MESHES)
+                {
+                // cull the instances of the batch and sort the visible ones from front to back.
+                const int end = min(count, start + TGX_RENDERER3D_MAX_SORTED_MESHES);
+                int nb = 0;
+                for (int i = start; i < end; i++)
+                    {
+                    const fMat4 MV = _viewM * models[i];
+                    if ((cull) && (_discard(bb, _projM * MV)))
                         {
-                        if (TGX_SHADER_HAS_TEXTURE(raster_type))
-                            _drawMesh<TGX_SHADER_GOURAUD | TGX_SHADER_TEXTURE>(mesh);
-                        else
-                            _drawMesh<TGX_SHADER_GOURAUD>(mesh);
+                        TGX_STAT(for (const Mesh3D<color_t>* m = mesh; m != nullptr; m = ((draw_chained_meshes) ? m->next : nullptr)) { _stats.triangles_submitted += m->nb_faces; _stats.triangles_discarded += m->nb_faces; });
+                        continue;
                         }
-                    else
+                    depth[nb] = -MV.mult1(center).z;
+                    ind[nb] = i;
+                    nb++;
+                    }
+                if (nb == 0) continue;
+                _sortByDepth(nb, depth, ind);
+                // draw the visible instances, one part of the object at a time.
+                for (const Mesh3D<color_t>* m = mesh; m != nullptr; m = ((draw_chained_meshes) ? m->next : nullptr))
+                    {
+                    if (!MeshReader<color_t>(m).hasVertices()) continue;
+                    const int raster_type = _setupMesh(shader, m, use_mesh_material);
+                    for (int k = 0; k < nb; k++)
                         {
-                        if (TGX_SHADER_HAS_TEXTURE(raster_type))
-                            _drawMesh<TGX_SHADER_FLAT | TGX_SHADER_TEXTURE>(mesh);
-                        else
-                            _drawMesh<TGX_SHADER_FLAT>(mesh);
+                        setModelMatrix(models[ind[k]]);
+                        if (colors) _r_objectColor = colors[ind[k]];
+                        _drawMeshRaster(raster_type, _selectLOD(m));
                         }
                     }
-                mesh = ((draw_chained_meshes) ? mesh->next : nullptr);
                 }
+            setModelMatrix(saveM);
 
             if (use_mesh_material)
                 { // restore material pre-computed values
                 _r_ambiantColor = _ambiantColor * _ambiantStrength;
                 _r_diffuseColor = _diffuseColor * _diffuseStrength;
                 _r_specularColor = _specularColor * _specularStrength;
-                _r_objectColor = _color;
                 }
+            _r_objectColor = _color;
             return 0;
             }
 
 
 
-        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::flush()
+            {
+            if (_bin_nb == 0) return 0; // nothing to do
+            const int r = _flushTriangles(_bin_buf, _bin_nb, _tl_valid);
+            _bin_nb = 0;
+            return r;
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::_flushTriangles(const RasterizerTriangle<color_t>* tris, int nb, bool binned)
+            {
+            if ((tris == nullptr) || (nb <= 0)) return 0; // nothing to do
+            if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
+
+            const bool deferred = (ZBUFFER) && (_deferred) && (_vis_buf != nullptr) && (_vis_len >= _imageBufferLen());
+
+            int nbtx, nbty;
+            _tileCount(nbtx, nbty);
+            const int nbtiles = nbtx * nbty;
+            if ((binned) && (!_tileListsMatch())) binned = false; // image, offset or tile size changed since binning: rebuild the lists.
+
+        #if TGX_MULTITHREAD
+            int nbthreads = (_bin_threads > 0) ? _bin_threads : (int)std::thread::hardware_concurrency();
+            nbthreads = clamp(nbthreads, 1, nbtiles);
+        #endif
+
+            int start = 0;
+            while (start < nb)
+                { // process the triangles by batches that fit in the tile lists
+                int end = nb;
+                bool lists = binned;
+                if (!binned)
+                    {
+                    lists = _tileListsReset();
+                    if (lists) { end = start; while ((end < nb) && (_tileListsAdd(end, tris[end]))) end++; }
+                    }
+            #if TGX_MULTITHREAD
+                std::atomic<int> next_tile(0);
+            #if TGX_RENDERER_STATS
+                std::atomic<uint32_t> tested(0), passed(0);
+            #endif
+                auto worker = [&]()
+                    {
+                    RasterizerParams<color_t, color_t, ZBUFFER_t> uni = _uni;
+                    TGX_STAT(uni.stat_tested = 0; uni.stat_passed = 0);
+                    int t;
+                    while ((t = next_tile++) < nbtiles)
+                        {
+                        const int tx = (t % nbtx) * _bin_tlx;
+                        const int ty = (t / nbtx) * _bin_tly;
+                        _rasterizeTile(t, iBox2(tx, tx + _bin_tlx - 1, ty, ty + _bin_tly - 1), deferred, tris, start, end, lists, uni);
+                        }
+                    TGX_STAT(tested += uni.stat_tested; passed += uni.stat_passed);
+                    };
+                _workers.run(nbthreads, worker);
+                TGX_STAT(_uni.stat_tested += tested; _uni.stat_passed += passed);
+            #else
+                RasterizerParams<color_t, color_t, ZBUFFER_t> uni = _uni;
+                for (int t = 0; t < nbtiles; t++)
+                    {
+                    const int tx = (t % nbtx) * _bin_tlx;
+                    const int ty = (t / nbtx) * _bin_tly;
+                    _rasterizeTile(t, iBox2(tx, tx + _bin_tlx - 1, ty, ty + _bin_tly - 1), deferred, tris, start, end, lists, uni);
+                    }
+                TGX_STAT(_uni.stat_tested = uni.stat_tested; _uni.stat_passed = uni.stat_passed);
+            #endif
+                start = end;
+                }
+            _tl_valid = false;
+            return 0;
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
         template<int RASTER_TYPE>
-        void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::_drawMesh(const Mesh3D<color_t>* mesh)
+        void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::_drawMesh(const Mesh3D<color_t>* mesh)
             {
             _uni.shader_type = RASTER_TYPE;
 
@@ -1773,45 +3557,60 @@ namespace tgx
             static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
 
             // check if the object is completely outside of the image for fast discard.
-            if (_discard(mesh->bounding_box, _projM * _r_modelViewM)) return;
+            TGX_STAT(_stats.triangles_submitted += mesh->nb_faces);
+            if (_discard(mesh->bounding_box, _projM * _r_modelViewM)) { TGX_STAT(_stats.triangles_discarded += mesh->nb_faces); return; }
 
             // check if the clipping test should be performed for each triangle in the mesh.
-            const bool cliptestneeded = _clipTestNeeded(clipboundXY, mesh->bounding_box, _projM * _r_modelViewM);
-
-            const fVec3* const tab_vert = mesh->vertice;  // array of vertices
-            const fVec3* const tab_norm = mesh->normal;   // array of normals
-            const fVec2* const tab_tex = mesh->texcoord;  // array of texture
-            const uint16_t* face = mesh->face;      // array of triangles
+            bool cliptestneeded = _clipTestNeeded(clipboundXY, mesh->bounding_box, _projM * _r_modelViewM);
 
             // set the texture.
             _uni.tex = (const Image<color_t>*)mesh->texture;
 
+            // use the post-transform vertex cache if available and large enough.
+            if ((_vcache_buf) && ((int)(mesh->nb_vertices * sizeof(_VCacheVertex) + mesh->nb_normals * sizeof(_VCacheNormal)) <= _vcache_len))
+                {
+                _drawMeshCached<RASTER_TYPE>(mesh, cliptestneeded);
+                return;
+                }
+
+            const MeshReader<color_t> reader(mesh);         // vertices, normals and texture coords (possibly quantized)
+            const bool has_tex = reader.hasTexcoords();     // true if the face array contains texture indices
+            const bool has_norm = reader.hasNormals();      // true if the face array contains normal indices
+            const uint16_t* face = mesh->face;      // array of triangles
+
             ExtVec4 QQA, QQB, QQC;
             ExtVec4* PC0 = &QQA;
             ExtVec4* PC1 = &QQB;
             ExtVec4* PC2 = &QQC;
 
+            _ClusterCulling cc;
+            _initClusterCulling(cc, mesh, cliptestneeded);
+
             int nbt;
-            while ((nbt = *(face++)) > 0)
-                { // starting a chain with nbt triangles
+            while (1)
+                {
+                if (cc.cl != cc.end) face = _cullClusters(cc, face, cliptestneeded); // skip the clusters culled as a whole
+                if ((nbt = *(face++)) == 0) break; // end tag
+                // starting a chain with nbt triangles
+                TGX_TRACE_SCOPE("drawMesh: chain"); // the vertex transform is the self time of this event (the rasterization is nested in it)
 
                 // load the first triangle
                 const uint16_t v0 = *(face++);
-                if (TEXTURE) PC0->indt = *(face++); else { if (tab_tex) face++; }
-                if (GOURAUD) PC0->indn = *(face++); else { if (tab_norm) face++; }
+                if (TEXTURE) PC0->indt = *(face++); else { if (has_tex) face++; }
+                if (GOURAUD) PC0->indn = *(face++); else { if (has_norm) face++; }
 
                 const uint16_t v1 = *(face++);
-                if (TEXTURE) PC1->indt = *(face++); else { if (tab_tex) face++; }
-                if (GOURAUD) PC1->indn = *(face++); else { if (tab_norm) face++; }
+                if (TEXTURE) PC1->indt = *(face++); else { if (has_tex) face++; }
+                if (GOURAUD) PC1->indn = *(face++); else { if (has_norm) face++; }
 
                 const uint16_t v2 = *(face++);
-                if (TEXTURE) PC2->indt = *(face++); else { if (tab_tex) face++; }
-                if (GOURAUD) PC2->indn = *(face++); else { if (tab_norm) face++; }
+                if (TEXTURE) PC2->indt = *(face++); else { if (has_tex) face++; }
+                if (GOURAUD) PC2->indn = *(face++); else { if (has_norm) face++; }
 
                 // compute vertices position because we are sure we will need them...
-                PC2->P = _r_modelViewM.mult1(tab_vert[v2]);
-                PC0->P = _r_modelViewM.mult1(tab_vert[v0]);
-                PC1->P = _r_modelViewM.mult1(tab_vert[v1]);
+                PC2->P = _r_modelViewM.mult1(reader.vertex(v2));
+                PC0->P = _r_modelViewM.mult1(reader.vertex(v0));
+                PC1->P = _r_modelViewM.mult1(reader.vertex(v1));
 
                 // ...but use lazy computation of other vertex attributes
                 PC0->missedP = true;
@@ -1823,7 +3622,7 @@ namespace tgx
                     // face culling
                     fVec3 faceN = crossProduct(PC1->P - PC0->P, PC2->P - PC0->P);
                     const float cu = (ORTHO) ? dotProduct(faceN, fVec3(0.0f, 0.0f, -1.0f)) : dotProduct(faceN, PC0->P);
-                    if (cu * _culling_dir > 0) goto rasterize_next_triangle; // skip triangle !
+                    if (cu * _culling_dir > 0) { TGX_STAT(_stats.triangles_backface++); goto rasterize_next_triangle; } // skip triangle !
                     // triangle is not culled
                     if (cliptestneeded)
                         {
@@ -1857,7 +3656,7 @@ namespace tgx
                             }
                         // for the time being, we just drop the triangles that need clipping
                         // *** TODO : implement correct clipping ***
-                        if (needclip) goto rasterize_next_triangle;
+                        if (needclip) { TGX_STAT(_stats.triangles_clipped++); goto rasterize_next_triangle; }
                         }
                     else
                         {
@@ -1887,15 +3686,15 @@ namespace tgx
                         const float icu = (_culling_dir != 0) ? 1.0f : ((cu > 0) ? -1.0f : 1.0f);
                         if (PC0->missedP)
                             {
-                            PC0->N = _r_modelViewM.mult0(tab_norm[PC0->indn]);
+                            PC0->N = _r_modelViewM.mult0(reader.normal(PC0->indn));
                             PC0->color = _phong<TEXTURE>(icu * dotProduct(PC0->N, _r_light_inorm), icu * dotProduct(PC0->N, _r_H_inorm));
                             }
                         if (PC1->missedP)
                             {
-                            PC1->N = _r_modelViewM.mult0(tab_norm[PC1->indn]);
+                            PC1->N = _r_modelViewM.mult0(reader.normal(PC1->indn));
                             PC1->color = _phong<TEXTURE>(icu * dotProduct(PC1->N, _r_light_inorm), icu * dotProduct(PC1->N, _r_H_inorm));
                             }
-                        PC2->N = _r_modelViewM.mult0(tab_norm[PC2->indn]);
+                        PC2->N = _r_modelViewM.mult0(reader.normal(PC2->indn));
                         PC2->color = _phong<TEXTURE>(icu * dotProduct(PC2->N, _r_light_inorm), icu * dotProduct(PC2->N, _r_H_inorm));
                         }
                     else
@@ -1907,9 +3706,9 @@ namespace tgx
 
                     if (TEXTURE)
                         { // compute texture vectors if needed
-                        if (PC0->missedP) { PC0->T = tab_tex[PC0->indt]; }
-                        if (PC1->missedP) { PC1->T = tab_tex[PC1->indt]; }
-                        PC2->T = tab_tex[PC2->indt];
+                        if (PC0->missedP) { PC0->T = reader.texcoord(PC0->indt); }
+                        if (PC1->missedP) { PC1->T = reader.texcoord(PC1->indt); }
+                        PC2->T = reader.texcoord(PC2->indt);
                         }
 
                     // attributes are now all up to date
@@ -1918,7 +3717,7 @@ namespace tgx
                     PC2->missedP = false;
 
                     // go rasterize !                   
-                    rasterizeTriangle<LX, LY> ((RasterizerVec4)QQA, (RasterizerVec4)QQB, (RasterizerVec4)QQC, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
+                    _rasterizeTriangle(QQA, QQB, QQC);
 
                 
                 rasterize_next_triangle:
@@ -1928,9 +3727,9 @@ namespace tgx
                     // get the next triangle
                     const uint16_t nv2 = *(face++);
                     swap(((nv2 & 32768) ? PC0 : PC1), PC2);
-                    if (TEXTURE) PC2->indt = *(face++); else { if (tab_tex) face++; }
-                    if (GOURAUD) PC2->indn = *(face++);  else { if (tab_norm) face++; }
-                    PC2->P = _r_modelViewM.mult1(tab_vert[nv2 & 32767]);
+                    if (TEXTURE) PC2->indt = *(face++); else { if (has_tex) face++; }
+                    if (GOURAUD) PC2->indn = *(face++);  else { if (has_norm) face++; }
+                    PC2->P = _r_modelViewM.mult1(reader.vertex(nv2 & 32767));
                     PC2->missedP = true;
                     }
                 }
@@ -1940,15 +3739,131 @@ namespace tgx
 
 
 
-        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
-        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::drawTriangles(int shader, int nb_triangles,
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        template<int RASTER_TYPE>
+        void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::_drawMeshCached(const Mesh3D<color_t>* mesh, const bool mesh_cliptestneeded)
+            {
+            static const bool TEXTURE = (bool)(TGX_SHADER_HAS_TEXTURE(RASTER_TYPE));
+            static const bool GOURAUD = (bool)(TGX_SHADER_HAS_GOURAUD(RASTER_TYPE));
+
+            // new stamp: all entries in the cache become stale
+            if (++_vcache_stamp == 0)
+                { // wrap around: clear the cache
+                memset(_vcache_buf, 0, _vcache_len);
+                _vcache_stamp = 1;
+                }
+
+            const MeshReader<color_t> reader(mesh);         // vertices, normals and texture coords (possibly quantized)
+            const bool has_tex = reader.hasTexcoords();     // true if the face array contains texture indices
+            const bool has_norm = reader.hasNormals();      // true if the face array contains normal indices
+            const uint16_t* face = mesh->face;      // array of triangles
+
+            _VCacheNormal* const tab_ncache = (_VCacheNormal*)(((_VCacheVertex*)_vcache_buf) + mesh->nb_vertices);
+
+            RasterizerVec4 QQ[3];       // vertices passed to the rasterizer
+            int vind[3], tind[3], nind[3];  // vertex/texture/normal indices for each slot in QQ
+            int p[3] = { 0, 1, 2 };     // current triangle is [QQ[p[0]], QQ[p[1]], QQ[p[2]]]
+
+            // the vertices of a cluster for which the clipping test is skipped do not need clipping
+            // so the clip flags stored in the cache remain valid for the other clusters.
+            bool cliptestneeded = mesh_cliptestneeded;
+            _ClusterCulling cc;
+            _initClusterCulling(cc, mesh, cliptestneeded);
+
+            int nbt;
+            while (1)
+                {
+                if (cc.cl != cc.end) face = _cullClusters(cc, face, cliptestneeded); // skip the clusters culled as a whole
+                if ((nbt = *(face++)) == 0) break; // end tag
+                // starting a chain with nbt triangles
+                TGX_TRACE_SCOPE("drawMesh: chain"); // the vertex transform is the self time of this event (the rasterization is nested in it)
+
+                // load the first triangle
+                for (int k = 0; k < 3; k++)
+                    {
+                    vind[p[k]] = *(face++);
+                    if (has_tex) tind[p[k]] = *(face++);
+                    if (has_norm) nind[p[k]] = *(face++);
+                    }
+
+                while (1)
+                    {
+                    {
+                    const auto & A = _cachedVertex(reader, vind[p[0]], cliptestneeded);
+                    const auto & B = _cachedVertex(reader, vind[p[1]], cliptestneeded);
+                    const auto & C = _cachedVertex(reader, vind[p[2]], cliptestneeded);
+
+                    // face culling
+                    fVec3 faceN = crossProduct(B.P - A.P, C.P - A.P);
+                    const float cu = (ORTHO) ? dotProduct(faceN, fVec3(0.0f, 0.0f, -1.0f)) : dotProduct(faceN, A.P);
+                    if (cu * _culling_dir > 0) { TGX_STAT(_stats.triangles_backface++); goto rasterize_next_triangle; } // skip triangle !
+
+                    // for the time being, we just drop the triangles that need clipping
+                    if (A.clip | B.clip | C.clip) { TGX_STAT(_stats.triangles_clipped++); goto rasterize_next_triangle; }
+
+                    *((fVec4*)&QQ[p[0]]) = A.S;
+                    *((fVec4*)&QQ[p[1]]) = B.S;
+                    *((fVec4*)&QQ[p[2]]) = C.S;
+
+                    if (GOURAUD)
+                        { // Gouraud shading : color on vertices
+                        if (_culling_dir != 0)
+                            { // colors are cached
+                            for (int k = 0; k < 3; k++) QQ[k].color = _cachedNormal<TEXTURE>(tab_ncache, reader, nind[k]).color;
+                            }
+                        else
+                            { // reverse normal depending on the face orientation (normals are given for the CCW face).
+                            const float icu = ((cu > 0) ? -1.0f : 1.0f);
+                            for (int k = 0; k < 3; k++)
+                                {
+                                const fVec3 & N = _cachedNormal<TEXTURE>(tab_ncache, reader, nind[k]).N;
+                                QQ[k].color = _phong<TEXTURE>(icu * dotProduct(N, _r_light_inorm), icu * dotProduct(N, _r_H_inorm));
+                                }
+                            }
+                        }
+                    else
+                        { // flat shading : color on faces
+                        const float icu = ((cu > 0) ? -1.0f : 1.0f); // -1 if we need to reverse the face normal.
+                        faceN.normalize();
+                        _uni.facecolor = _phong<TEXTURE>(icu * dotProduct(faceN, _r_light), icu * dotProduct(faceN, _r_H));
+                        }
+
+                    if (TEXTURE)
+                        {
+                        for (int k = 0; k < 3; k++) QQ[k].T = reader.texcoord(tind[k]);
+                        }
+
+                    // go rasterize !
+                    _rasterizeTriangle(QQ[0], QQ[1], QQ[2]);
+                    }
+
+                rasterize_next_triangle:
+
+                    if (--nbt == 0) break; // exit loop at end of chain
+
+                    // get the next triangle
+                    const uint16_t nv2 = *(face++);
+                    swap(p[(nv2 & 32768) ? 0 : 1], p[2]);
+                    vind[p[2]] = nv2 & 32767;
+                    if (has_tex) tind[p[2]] = *(face++);
+                    if (has_norm) nind[p[2]] = *(face++);
+                    }
+                }
+            }
+
+
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::drawTriangles(int shader, int nb_triangles,
             const uint16_t* ind_vertices, const fVec3* vertices,
             const uint16_t* ind_normals, const fVec3* normals,
             const uint16_t* ind_texture, const fVec2* textures,
             const Image<color_t>* texture_image)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             if ((ind_vertices == nullptr) || (vertices == nullptr)) return -3; // invalid vertices
             if ((ind_normals == nullptr) || (normals == nullptr)) TGX_SHADER_REMOVE_GOURAUD(shader) // disable gouraud            
             if ((ind_texture == nullptr) || (textures == nullptr) || (texture_image == nullptr)) TGX_SHADER_REMOVE_TEXTURE(shader) // disable texture
@@ -2007,15 +3922,15 @@ namespace tgx
 
 
 
-        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
-        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::drawQuads(int shader, int nb_quads,
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO, typename ZBUFFER_t>
+        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO, ZBUFFER_t>::drawQuads(int shader, int nb_quads,
             const uint16_t* ind_vertices, const fVec3* vertices,
             const uint16_t* ind_normals, const fVec3* normals,
             const uint16_t* ind_texture, const fVec2* textures,
             const Image<color_t>* texture_image)
             {
             if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
-            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly()))) return -2; // zbuffer required but not available.
+            if ((ZBUFFER) && ((_uni.zbuf == nullptr) || (_zbuffer_len < _imageBufferLen()))) return -2; // zbuffer required but not available.
             if ((ind_vertices == nullptr) || (vertices == nullptr)) return -3; // invalid vertices
             if ((ind_normals == nullptr) || (normals == nullptr)) TGX_SHADER_REMOVE_GOURAUD(shader); // disable gouraud
             if ((ind_texture == nullptr) || (textures == nullptr) || (texture_image == nullptr)) TGX_SHADER_REMOVE_TEXTURE(shader) // disable texture
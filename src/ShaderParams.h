@@ -57,6 +57,85 @@ namespace tgx
 	#define TGX_SHADER_REMOVE_TEXTURE(shader_type) { shader_type &= ~(TGX_SHADER_TEXTURE); }
 
 
+	/**
+	* Return the index of texel (x,y) in a texture buffer with a given stride.
+	*
+	* - TILED = false: usual row-major layout.
+	* - TILED = true : the texture is stored by blocks of 4x4 texels (the blocks being in
+	*                  row-major order and the texels of a block also being in row-major order)
+	*                  so that neighbouring texels in any direction are usually in the same
+	*                  cache line. See Image::copyTiled().
+	**/
+	template<bool TILED> TGX_INLINE inline int32_t texelIndex(const int32_t x, const int32_t y, const int32_t stride)
+		{
+		if (TILED)
+			return ((y & ~3) * stride) + ((x & ~3) << 2) + ((y & 3) << 2) + (x & 3);
+		else
+			return x + (y * stride);
+		}
+
+
+	/**
+	* Depth test: return true if the depth cw (already scaled by zoff/zmul) is closer than
+	* the value W stored in the zbuffer, in which case W is also updated.
+	*
+	* With a uint32_t zbuffer, each entry packs the epoch (frame counter) during which the
+	* pixel was written in its 8 high bits and the quantized depth in its 24 low bits.
+	* data.zepoch holds the current epoch (already shifted). Entries written during a previous
+	* epoch are smaller than any entry written during the current one so they behave as
+	* cleared pixels: clearing the zbuffer just amounts to incrementing the epoch.
+	*
+	* The test sets data.zpassed when the pixel passes (so the rasterizer knows which blocks of
+	* the hierarchical zbuffer were modified). When TGX_RENDERER_STATS is set, it also updates
+	* the pixel counters of data.
+	**/
+	template<typename ZBUFFER_t, typename RASTERIZER_PARAMS> TGX_INLINE inline bool depthTest(ZBUFFER_t& W, const float cw, const RASTERIZER_PARAMS& data)
+		{
+		TGX_STAT(data.stat_tested++);
+		if (W < cw)
+			{
+			TGX_STAT(data.stat_passed++);
+			data.zpassed = true;
+			W = (ZBUFFER_t)cw;
+			return true;
+			}
+		return false;
+		}
+
+
+	/** epoch zbuffer version */
+	template<typename RASTERIZER_PARAMS> TGX_INLINE inline bool depthTest(uint32_t& W, const float cw, const RASTERIZER_PARAMS& data)
+		{
+		TGX_STAT(data.stat_tested++);
+		const uint32_t z = data.zepoch | min((uint32_t)cw, (uint32_t)0x00FFFFFF);
+		if (W < z)
+			{
+			TGX_STAT(data.stat_passed++);
+			data.zpassed = true;
+			W = z;
+			return true;
+			}
+		return false;
+		}
+
+
+	/**
+	* Return the depth (in the same unit as cw above) stored in a zbuffer entry.
+	* With a uint32_t zbuffer, entries from previous epochs have depth 0 (cleared).
+	**/
+	template<typename ZBUFFER_t> TGX_INLINE inline float zbufferDepth(const ZBUFFER_t W, const uint32_t)
+		{
+		return (float)W;
+		}
+
+
+	/** epoch zbuffer version */
+	template<> TGX_INLINE inline float zbufferDepth<uint32_t>(const uint32_t W, const uint32_t zepoch)
+		{
+		return ((W & 0xFF000000) == zepoch) ? (float)(W & 0x00FFFFFF) : 0.0f;
+		}
+
+
 	//forward declaration
 	template<typename color_t> class Image;
 
@@ -75,20 +154,71 @@ namespace tgx
 
 
 
+	/**
+	* Vertex with user defined varying parameters
+	*
+	* Used with ShaderFunctor (see Shaders.h). VARYINGS is a user struct that must only
+	* contain floats (float, fVec2, fVec3, fVec4, RGBf members...): it is interpolated
+	* component-wise across the triangle.
+	**/
+	template<typename VARYINGS> struct RasterizerVertex : public tgx::fVec4
+		{
+		VARYINGS var;		// user defined varying parameters
+		};
+
+
+
 	/**
 	* Uniform parameters
 	*
 	* Structure that holds the 'uniform' parameters (in opengl sense) passed
-	* to the triangle rasterizer when doing 3D rendering
+	* to the triangle rasterizer when doing 3D rendering. 
+	* 
+	* ZBUFFER_t is the type of the depth buffer: either float, uint16_t or uint32_t. With a 
+	* uint16_t zbuffer, the depth w is quantized to (w + zoff)*zmul which must lie
+	* in [0, 65535]. With a uint32_t (epoch) zbuffer, it must lie in [0, 2^24 - 1] and 
+	* is combined with zepoch (see depthTest()).
 	**/
-	template<typename color_t_im, typename color_t_tex> struct RasterizerParams
+	template<typename color_t_im, typename color_t_tex, typename ZBUFFER_t = float> struct RasterizerParams
 		{
 		int shader_type;				// shader type
 		Image<color_t_im> * im;			// pointer to the destination image to draw onto
-		float* zbuf;					// pointer to the z buffer (when using depth testing).
+		ZBUFFER_t* zbuf;				// pointer to the z buffer (when using depth testing).
+		float zmul, zoff;				// depth written in the zbuffer is (w + zoff)*zmul (zoff = 0, zmul = 1 for a float zbuffer).
+		uint32_t zepoch;				// current epoch in the 8 high bits (when using a uint32_t zbuffer).
 		RGBf facecolor;					// pointer to the face color (when using flat shading).  
 		const Image<color_t_tex>* tex;	// pointer to the texture (when using texturing).
         bool use_bilinear_texturing;    // true to use bilinear point sampling (when using texturing).
+		bool use_tiled_textures;		// true if textures are stored with a 4x4 tiled layout (when using texturing).
+		int32_t tex_subspan;			// perspective correct texture coords computed every tex_subspan pixels (0 = every pixel).
+		float tex_subspan_maxerr;		// max error (in texels) allowed when interpolating texture coords between subspans.
+		float* hiz;						// pointer to the hierarchical zbuffer (min depth of each 8x8 block) or nullptr if not used.
+		int32_t hiz_stride;				// stride of the hierarchical zbuffer (number of blocks per row).
+		uint32_t* vbuf;					// pointer to the visibility buffer (when using deferred rendering).
+		uint32_t vid;					// id of the triangle written in the visibility buffer (when using deferred rendering).
+		mutable bool zpassed;			// set by the shaders when a pixel passes the depth test (reset by the rasterizer for each triangle).
+#if TGX_RENDERER_STATS
+		mutable uint32_t stat_tested;	// number of pixels depth tested.
+		mutable uint32_t stat_passed;	// number of pixels that passed the depth test.
+#endif
+		};
+
+
+
+	/**
+	* Binned triangle
+	*
+	* Triangle stored by the renderer (after transformation and projection) when
+	* binned rendering is enabled. It holds the 3 vertices together with the 'uniform'
+	* parameters that may change from one triangle to the next.
+	**/
+	template<typename color_t_tex> struct RasterizerTriangle
+		{
+		RasterizerVec4 V0, V1, V2;			// normalized coordinates of the vertices (+ varying parameters)
+		RGBf facecolor;						// face color (when using flat shading).
+		const Image<color_t_tex>* tex;		// pointer to the texture (when using texturing).
+		int shader_type;					// shader type
+		int16_t xmin, xmax, ymin, ymax;		// bounding box of the triangle in the viewport (inclusive)
 		};
 
 
@@ -0,0 +1,722 @@
+/** @file ShaderSpans.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+#ifndef _TGX_SHADERSPANS_H_
+#define _TGX_SHADERSPANS_H_
+
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Color.h"
+
+#include <stdint.h>
+
+#if TGX_USE_SIMD
+    #if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #include <arm_neon.h>
+        #define TGX_SIMD_NEON
+    #else
+        #include <emmintrin.h>
+        #define TGX_SIMD_SSE2
+    #endif
+#endif
+
+
+namespace tgx
+{
+
+
+	/**
+	* Incremental interpolation of 3 values (typically the R,G,B channels of a color) over
+	* a triangle using fixed point arithmetic with FRAC fractional bits.
+	*
+	* Each value is an affine function of the edge functions C2 and C3 of the triangle:
+	* v = v1 + C2*(v2 - v1)/aera + C3*(v3 - v1)/aera. The gradients are computed once per
+	* triangle with setup(), the value at the start of a span once per scanline with begin()
+	* and then moving to the next pixel with step() only costs 3 integer additions.
+	*
+	* A rounding bias slightly smaller than 1/2 is added so that the accumulated error over
+	* a span (less than 1/32 for spans shorter than 2048 pixels) can never push the result
+	* outside of the range spanned by the vertex values.
+	**/
+	template<int FRAC> struct FixedGradient3
+		{
+		int32_t r, g, b;		// current values (fixed point)
+		int32_t dr, dg, db;		// increment when moving to the next pixel on the scanline
+		float fr, fg, fb;		// values when C2 = C3 = 0 (fixed point + rounding bias)
+		float r2, g2, b2;		// derivatives w.r.t. C2 (fixed point)
+		float r3, g3, b3;		// derivatives w.r.t. C3 (fixed point)
+
+
+		/** compute the gradients (once per triangle). */
+		TGX_INLINE void setup(const float v1r, const float v1g, const float v1b,
+			const float v2r, const float v2g, const float v2b,
+			const float v3r, const float v3g, const float v3b,
+			const int32_t aera, const int32_t dx2, const int32_t dx3)
+			{
+			const float one = (float)(1 << FRAC);
+			const float bias = (float)((1 << (FRAC - 1)) - (1 << (FRAC - 4)));
+			const float m = one / aera;
+			fr = (v1r * one) + bias; fg = (v1g * one) + bias; fb = (v1b * one) + bias;
+			r2 = (v2r - v1r) * m; g2 = (v2g - v1g) * m; b2 = (v2b - v1b) * m;
+			r3 = (v3r - v1r) * m; g3 = (v3g - v1g) * m; b3 = (v3b - v1b) * m;
+			dr = (int32_t)lroundf((dx2 * r2) + (dx3 * r3));
+			dg = (int32_t)lroundf((dx2 * g2) + (dx3 * g3));
+			db = (int32_t)lroundf((dx2 * b2) + (dx3 * b3));
+			}
+
+
+		/** set the current values at the start of a span (once per scanline). */
+		TGX_INLINE void begin(const int32_t C2, const int32_t C3)
+			{
+			const float fC2 = (float)C2, fC3 = (float)C3;
+			r = (int32_t)(fr + (fC2 * r2) + (fC3 * r3));
+			g = (int32_t)(fg + (fC2 * g2) + (fC3 * g3));
+			b = (int32_t)(fb + (fC2 * b2) + (fC3 * b3));
+			}
+
+
+		/** move to the next pixel on the scanline */
+		TGX_INLINE void step()
+			{
+			r += dr;
+			g += dg;
+			b += db;
+			}
+
+
+		/** integer part of the current values */
+		TGX_INLINE int32_t R() const { return (r >> FRAC); }
+		TGX_INLINE int32_t G() const { return (g >> FRAC); }
+		TGX_INLINE int32_t B() const { return (b >> FRAC); }
+
+		};
+
+
+
+	/**
+	* Incremental gouraud color interpolation over a triangle (no per pixel division).
+	*
+	* The color is interpolated between the vertex colors col1, col2 and col3 associated with
+	* the edge functions C1, C2 and C3. Usage:
+	*
+	*     GouraudGradient<color_t> grad;
+	*     grad.setup(col1, col2, col3, aera, dx2, dx3);   // once per triangle
+	*     grad.begin(C2, C3);                             // once per scanline
+	*     buf[bx] = grad.color(); grad.step();            // for each pixel
+	*
+	* The generic version interpolates the channels of RGBf colors with floats. The integer
+	* color types (RGB565, RGB24, RGB32, RGB64) use a fixed point version in native channel
+	* units.
+	**/
+	template<typename color_t> struct GouraudGradient
+		{
+		RGBf c, d;			// current color and increment when moving to the next pixel
+		RGBf c1, c2, c3;	// color when C2 = C3 = 0 and derivatives w.r.t. C2 and C3
+
+		TGX_INLINE void setup(const color_t col1, const color_t col2, const color_t col3, const int32_t aera, const int32_t dx2, const int32_t dx3)
+			{
+			const float ia = 1.0f / aera;
+			c1 = RGBf(col1);
+			const RGBf f2(col2), f3(col3);
+			c2 = RGBf((f2.R - c1.R) * ia, (f2.G - c1.G) * ia, (f2.B - c1.B) * ia);
+			c3 = RGBf((f3.R - c1.R) * ia, (f3.G - c1.G) * ia, (f3.B - c1.B) * ia);
+			d = RGBf((dx2 * c2.R) + (dx3 * c3.R), (dx2 * c2.G) + (dx3 * c3.G), (dx2 * c2.B) + (dx3 * c3.B));
+			}
+
+		TGX_INLINE void begin(const int32_t C2, const int32_t C3)
+			{
+			c = RGBf(c1.R + (C2 * c2.R) + (C3 * c3.R), c1.G + (C2 * c2.G) + (C3 * c3.G), c1.B + (C2 * c2.B) + (C3 * c3.B));
+			}
+
+		TGX_INLINE void step()
+			{
+			c.R += d.R;
+			c.G += d.G;
+			c.B += d.B;
+			}
+
+		TGX_INLINE color_t color() const { return color_t(c); }
+		};
+
+
+	/** fixed point gouraud interpolation for the integer color types */
+	template<typename color_t, int FRAC> struct GouraudGradientFixed : public FixedGradient3<FRAC>
+		{
+		TGX_INLINE void setup(const color_t col1, const color_t col2, const color_t col3, const int32_t aera, const int32_t dx2, const int32_t dx3)
+			{
+			FixedGradient3<FRAC>::setup((float)col1.R, (float)col1.G, (float)col1.B,
+										(float)col2.R, (float)col2.G, (float)col2.B,
+										(float)col3.R, (float)col3.G, (float)col3.B, aera, dx2, dx3);
+			}
+
+		TGX_INLINE color_t color() const { return color_t((int)this->R(), (int)this->G(), (int)this->B()); }
+		};
+
+	template<> struct GouraudGradient<RGB565> : public GouraudGradientFixed<RGB565, 16> {};
+	template<> struct GouraudGradient<RGB24> : public GouraudGradientFixed<RGB24, 16> {};
+	template<> struct GouraudGradient<RGB32> : public GouraudGradientFixed<RGB32, 16> {};
+	template<> struct GouraudGradient<RGB64> : public GouraudGradientFixed<RGB64, 14> {}; // 16 bits channels: keep room for the integer part
+
+
+
+	/**
+	* Texture coordinates along the spans of a triangle drawn with perspective correct texturing.
+	*
+	* The texture coords at a pixel are (tx/cw, ty/cw) where tx, ty and cw are affine functions
+	* maintained by the shader. When sub = 0, the division is performed at each pixel. Otherwise,
+	* the exact coords are computed every sub pixels and linearly interpolated in between, as
+	* classic software renderers did. The error of the interpolation at the middle of a subspan
+	* (which is close to the max error) is |u1 - u0| * |cw1 - cw0| / (2 * (cw0 + cw1)) where u0, u1
+	* are the exact coords at both ends. When this exceeds maxerr texels (on either axis), the subspan is
+	* computed exactly instead.
+	**/
+	struct TexSubspan
+		{
+		float dtx, dty, dw;		// increments of tx, ty and cw per pixel
+		float u, v;				// texture coords at the current pixel (when interpolating)
+		float du, dv;			// increments of u and v in the current subspan
+		float u1, v1;			// exact coords at the end of the current subspan
+		float fsub, isub;		// length of subspans and its inverse
+		float maxerr2;			// twice the max error allowed (in texels)
+		int32_t sub;			// length of subspans (0 = exact for every pixel)
+		int32_t left;			// number of pixels before the next subspan
+		bool affine;			// true if the current subspan is interpolated
+		bool has_end;			// true if u1 and v1 are valid
+
+
+		/** set up (once per triangle). */
+		TGX_INLINE void setup(const int32_t subspan, const float maxerr, const float dtx_, const float dty_, const float dw_)
+			{
+			dtx = dtx_; dty = dty_; dw = dw_;
+			sub = (subspan > 1) ? subspan : 0;
+			fsub = (float)sub;
+			isub = (sub) ? (1.0f / fsub) : 0.0f;
+			maxerr2 = 2 * maxerr;
+			u = v = du = dv = u1 = v1 = 0.0f;
+			left = 0;
+			affine = false;
+			has_end = false;
+			}
+
+
+		/** start a new span (once per scanline). */
+		TGX_INLINE void begin(const float tx, const float ty, const float cw)
+			{
+			if (sub)
+				{
+				has_end = false;
+				next(tx, ty, cw);
+				}
+			}
+
+
+		/** return the texture coords at the current pixel */
+		TGX_INLINE void texcoord(const float tx, const float ty, const float cw, float & xx, float & yy) const
+			{
+			if (affine)
+				{
+				xx = u;
+				yy = v;
+				}
+			else
+				{
+				const float icw = 1.0f / cw;
+				xx = tx * icw;
+				yy = ty * icw;
+				}
+			}
+
+
+		/** move to the next pixel (tx, ty and cw must already be updated) */
+		TGX_INLINE void step(const float tx, const float ty, const float cw)
+			{
+			if (sub)
+				{
+				u += du;
+				v += dv;
+				if (--left == 0) next(tx, ty, cw);
+				}
+			}
+
+
+		/** compute the next subspan, starting at the current pixel */
+		void next(const float tx, const float ty, const float cw)
+			{
+			left = sub;
+			affine = false;
+			const float cw1 = cw + (fsub * dw);
+			if ((cw <= 0) || (cw1 <= 0)) { has_end = false; return; } // extrapolated past the triangle: use exact coords.
+			if (has_end)
+				{ // continue from the end of the previous subspan
+				u = u1;
+				v = v1;
+				}
+			else
+				{
+				const float icw = 1.0f / cw;
+				u = tx * icw;
+				v = ty * icw;
+				}
+			const float icw1 = 1.0f / cw1;
+			u1 = (tx + (fsub * dtx)) * icw1;
+			v1 = (ty + (fsub * dty)) * icw1;
+			has_end = true;
+			const float e = max(fabsf(u1 - u), fabsf(v1 - v)) * fabsf(cw1 - cw);
+			if (e > maxerr2 * (cw + cw1)) return; // too much distortion: use exact coords.
+			du = (u1 - u) * isub;
+			dv = (v1 - v) * isub;
+			affine = true;
+			}
+
+		};
+
+
+
+	/**
+	* Return true if the rectangle [0, lx[x[0, ly[ (relative to the first pixel passed to the shader)
+	* is entirely inside the triangle, i.e. if the three edge functions are non negative at its four
+	* corners (they are affine). The shaders can then draw it without any per pixel edge test.
+	**/
+	TGX_INLINE bool rectInsideTriangle(const int32_t lx, const int32_t ly,
+		const int32_t dx1, const int32_t dy1, const int32_t O1,
+		const int32_t dx2, const int32_t dy2, const int32_t O2,
+		const int32_t dx3, const int32_t dy3, const int32_t O3)
+		{
+		const int32_t ex = lx - 1;
+		const int32_t ey = ly - 1;
+		const int32_t X1 = O1 + (ex * dx1), Y1 = O1 + (ey * dy1);
+		const int32_t X2 = O2 + (ex * dx2), Y2 = O2 + (ey * dy2);
+		const int32_t X3 = O3 + (ex * dx3), Y3 = O3 + (ey * dy3);
+		return ((O1 | O2 | O3 | X1 | X2 | X3 | Y1 | Y2 | Y3 | (X1 + (ey * dy1)) | (X2 + (ey * dy2)) | (X3 + (ey * dy3))) >= 0);
+		}
+
+
+
+	/**
+	* Span kernels used by the shaders.
+	*
+	* Each method draws the pixels of a single scanline of a triangle: starting at index bx,
+	* pixels are drawn as long as bx < lx and (C2 | C3) >= 0 where the edge functions C2 and
+	* C3 are incremented by dx2 and dx3 after each pixel (and the depth cw by dw when using
+	* the zbuffer). data holds the uniform parameters used by the depth test (see depthTest()).
+	*
+	* The '_full' variants draw a span entirely inside the triangle (see rectInsideTriangle())
+	* and thus skip the edge tests altogether.
+	*
+	* SpanKernelScalar is plain C++ code. Specializations of SpanKernel for RGB565 and RGB32
+	* that process 4 pixels at once with SIMD instructions (SSE2 or NEON) are selected at
+	* compile time when TGX_USE_SIMD is set. Both versions draw exactly the same pixels
+	* but the depth values written by the SIMD version may differ in the last bits since
+	* they are not obtained by repeated additions.
+	**/
+	template<typename color_t> struct SpanKernelScalar
+		{
+
+		/** flat shading, no depth test */
+		static TGX_INLINE void flat(color_t* buf, int32_t bx, const int32_t lx,
+			int32_t C2, int32_t C3, const int32_t dx2, const int32_t dx3,
+			const color_t col)
+			{
+			while ((bx < lx) && ((C2 | C3) >= 0))
+				{
+				buf[bx] = col;
+				C2 += dx2;
+				C3 += dx3;
+				bx++;
+				}
+			}
+
+
+		/** flat shading with depth test */
+		template<typename ZBUFFER_t, typename RASTERIZER_PARAMS>
+		static TGX_INLINE void flat_zbuffer(color_t* buf, ZBUFFER_t* zbuf, int32_t bx, const int32_t lx,
+			int32_t C2, int32_t C3, const int32_t dx2, const int32_t dx3,
+			float cw, const float dw, const RASTERIZER_PARAMS& data,
+			const color_t col)
+			{
+			while ((bx < lx) && ((C2 | C3) >= 0))
+				{
+				if (depthTest(zbuf[bx], cw, data))
+					{
+					buf[bx] = col;
+					}
+				C2 += dx2;
+				C3 += dx3;
+				cw += dw;
+				bx++;
+				}
+			}
+
+
+		/** flat shading of the span [0, lx[ entirely inside the triangle, no depth test */
+		static TGX_INLINE void flat_full(color_t* buf, const int32_t lx, const color_t col)
+			{
+			for (int32_t bx = 0; bx < lx; bx++) buf[bx] = col;
+			}
+
+
+		/** flat shading with depth test of the span [0, lx[ entirely inside the triangle */
+		template<typename ZBUFFER_t, typename RASTERIZER_PARAMS>
+		static TGX_INLINE void flat_zbuffer_full(color_t* buf, ZBUFFER_t* zbuf, const int32_t lx,
+			float cw, const float dw, const RASTERIZER_PARAMS& data,
+			const color_t col)
+			{
+			for (int32_t bx = 0; bx < lx; bx++)
+				{
+				if (depthTest(zbuf[bx], cw, data))
+					{
+					buf[bx] = col;
+					}
+				cw += dw;
+				}
+			}
+
+
+		/** gouraud shading with depth test (grad.begin() must have been called for the first pixel) */
+		template<typename ZBUFFER_t, typename RASTERIZER_PARAMS>
+		static TGX_INLINE void gouraud_zbuffer(color_t* buf, ZBUFFER_t* zbuf, int32_t bx, const int32_t lx,
+			int32_t C2, int32_t C3, const int32_t dx2, const int32_t dx3,
+			float cw, const float dw, const RASTERIZER_PARAMS& data,
+			GouraudGradient<color_t>& grad)
+			{
+			while ((bx < lx) && ((C2 | C3) >= 0))
+				{
+				if (depthTest(zbuf[bx], cw, data))
+					{
+					buf[bx] = grad.color();
+					}
+				C2 += dx2;
+				C3 += dx3;
+				cw += dw;
+				grad.step();
+				bx++;
+				}
+			}
+
+		};
+
+
+	/** span kernels used by the shaders for a given color type (default: plain C++) */
+	template<typename color_t> struct SpanKernel : public SpanKernelScalar<color_t> {};
+
+
+
+#if TGX_USE_SIMD
+
+
+	/**
+	* Minimal set of 4 lanes SIMD operations used by the span kernels.
+	**/
+	struct SpanSIMD
+		{
+
+#if defined(TGX_SIMD_SSE2)
+
+		typedef __m128i vint;
+		typedef __m128i vmask;
+		typedef __m128  vfloat;
+
+		static TGX_INLINE vint splat(const int32_t v) { return _mm_set1_epi32(v); }
+
+		static TGX_INLINE vint add(const vint a, const vint b) { return _mm_add_epi32(a, b); }
+
+		static TGX_INLINE vfloat splat(const float v) { return _mm_set1_ps(v); }
+
+		static TGX_INLINE vfloat add(const vfloat a, const vfloat b) { return _mm_add_ps(a, b); }
+
+		static TGX_INLINE vint ramp(const int32_t C, const int32_t d)
+			{
+			const uint32_t uC = (uint32_t)C, ud = (uint32_t)d; // wrap around exactly as the scalar code
+			return _mm_set_epi32((int32_t)(uC + 3*ud), (int32_t)(uC + 2*ud), (int32_t)(uC + ud), C);
+			}
+
+		static TGX_INLINE vfloat set(const float w0, const float w1, const float w2, const float w3) { return _mm_set_ps(w3, w2, w1, w0); }
+
+		/** mask of the lanes where (C2 | C3) >= 0 */
+		static TGX_INLINE vmask inside(const vint C2, const vint C3) { return _mm_cmpgt_epi32(_mm_or_si128(C2, C3), _mm_set1_epi32(-1)); }
+
+		/** bit k set iff lane k is set in the mask */
+		static TGX_INLINE int bits(const vmask m) { return _mm_movemask_ps(_mm_castsi128_ps(m)); }
+
+		/** number of lanes set in the mask */
+		static TGX_INLINE int count(const vmask m) { const int b = bits(m); return (b & 1) + ((b >> 1) & 1) + ((b >> 2) & 1) + (b >> 3); }
+
+		/** depth test for the lanes in m: update zbuf[0..3] and return the mask of the lanes that passed */
+		static TGX_INLINE vmask depth(const vmask m, float* zbuf, const vfloat w)
+			{
+			const __m128 z = _mm_loadu_ps(zbuf);
+			const __m128 mf = _mm_and_ps(_mm_castsi128_ps(m), _mm_cmplt_ps(z, w));
+			_mm_storeu_ps(zbuf, _mm_or_ps(_mm_and_ps(mf, w), _mm_andnot_ps(mf, z)));
+			return _mm_castps_si128(mf);
+			}
+
+		/** write col in buf[0..3] for the lanes in m */
+		static TGX_INLINE void store(const vmask m, uint16_t* buf, const uint16_t col)
+			{
+			const __m128i m16 = _mm_packs_epi32(m, m);
+			const __m128i b = _mm_loadl_epi64((const __m128i*)buf);
+			_mm_storel_epi64((__m128i*)buf, _mm_or_si128(_mm_and_si128(m16, _mm_set1_epi16((short)col)), _mm_andnot_si128(m16, b)));
+			}
+
+		/** write col in buf[0..3] for the lanes in m */
+		static TGX_INLINE void store(const vmask m, uint32_t* buf, const uint32_t col)
+			{
+			const __m128i b = _mm_loadu_si128((const __m128i*)buf);
+			_mm_storeu_si128((__m128i*)buf, _mm_or_si128(_mm_and_si128(m, _mm_set1_epi32((int32_t)col)), _mm_andnot_si128(m, b)));
+			}
+
+		/** mask with all lanes set */
+		static TGX_INLINE vmask all() { return _mm_set1_epi32(-1); }
+
+		/** write col in buf[0..3] */
+		static TGX_INLINE void fill(uint16_t* buf, const uint16_t col) { _mm_storel_epi64((__m128i*)buf, _mm_set1_epi16((short)col)); }
+
+		/** write col in buf[0..3] */
+		static TGX_INLINE void fill(uint32_t* buf, const uint32_t col) { _mm_storeu_si128((__m128i*)buf, _mm_set1_epi32((int32_t)col)); }
+
+#elif defined(TGX_SIMD_NEON)
+
+		typedef int32x4_t   vint;
+		typedef uint32x4_t  vmask;
+		typedef float32x4_t vfloat;
+
+		static TGX_INLINE vint splat(const int32_t v) { return vdupq_n_s32(v); }
+
+		static TGX_INLINE vint add(const vint a, const vint b) { return vaddq_s32(a, b); }
+
+		static TGX_INLINE vfloat splat(const float v) { return vdupq_n_f32(v); }
+
+		static TGX_INLINE vfloat add(const vfloat a, const vfloat b) { return vaddq_f32(a, b); }
+
+		static TGX_INLINE vint ramp(const int32_t C, const int32_t d)
+			{
+			const uint32_t uC = (uint32_t)C, ud = (uint32_t)d; // wrap around exactly as the scalar code
+			const int32_t t[4] = { C, (int32_t)(uC + ud), (int32_t)(uC + 2*ud), (int32_t)(uC + 3*ud) };
+			return vld1q_s32(t);
+			}
+
+		static TGX_INLINE vfloat set(const float w0, const float w1, const float w2, const float w3)
+			{
+			const float t[4] = { w0, w1, w2, w3 };
+			return vld1q_f32(t);
+			}
+
+		/** mask of the lanes where (C2 | C3) >= 0 */
+		static TGX_INLINE vmask inside(const vint C2, const vint C3) { return vcgeq_s32(vorrq_s32(C2, C3), vdupq_n_s32(0)); }
+
+		/** bit k set iff lane k is set in the mask */
+		static TGX_INLINE int bits(const vmask m)
+			{
+			static const uint32_t w[4] = { 1, 2, 4, 8 };
+			const uint32x4_t a = vandq_u32(m, vld1q_u32(w));
+			uint32x2_t t = vadd_u32(vget_low_u32(a), vget_high_u32(a));
+			t = vpadd_u32(t, t);
+			return (int)vget_lane_u32(t, 0);
+			}
+
+		/** number of lanes set in the mask */
+		static TGX_INLINE int count(const vmask m) { const int b = bits(m); return (b & 1) + ((b >> 1) & 1) + ((b >> 2) & 1) + (b >> 3); }
+
+		/** depth test for the lanes in m: update zbuf[0..3] and return the mask of the lanes that passed */
+		static TGX_INLINE vmask depth(const vmask m, float* zbuf, const vfloat w)
+			{
+			const float32x4_t z = vld1q_f32(zbuf);
+			const uint32x4_t mf = vandq_u32(m, vcltq_f32(z, w));
+			vst1q_f32(zbuf, vbslq_f32(mf, w, z));
+			return mf;
+			}
+
+		/** write col in buf[0..3] for the lanes in m */
+		static TGX_INLINE void store(const vmask m, uint16_t* buf, const uint16_t col)
+			{
+			vst1_u16(buf, vbsl_u16(vmovn_u32(m), vdup_n_u16(col), vld1_u16(buf)));
+			}
+
+		/** write col in buf[0..3] for the lanes in m */
+		static TGX_INLINE void store(const vmask m, uint32_t* buf, const uint32_t col)
+			{
+			vst1q_u32(buf, vbslq_u32(m, vdupq_n_u32(col), vld1q_u32(buf)));
+			}
+
+		/** mask with all lanes set */
+		static TGX_INLINE vmask all() { return vdupq_n_u32(0xFFFFFFFF); }
+
+		/** write col in buf[0..3] */
+		static TGX_INLINE void fill(uint16_t* buf, const uint16_t col) { vst1_u16(buf, vdup_n_u16(col)); }
+
+		/** write col in buf[0..3] */
+		static TGX_INLINE void fill(uint32_t* buf, const uint32_t col) { vst1q_u32(buf, vdupq_n_u32(col)); }
+
+#endif
+
+		/** depth of 4 consecutive pixels starting from cw */
+		static TGX_INLINE vfloat wramp(const float cw, const float dw) { return set(cw, cw + dw, cw + 2*dw, cw + 3*dw); }
+
+		};
+
+
+
+	/**
+	* SIMD span kernels for color types whose raw value is a uint16_t/uint32_t.
+	*
+	* Only flat shading is vectorized: for gouraud shading, the per pixel color blending
+	* dominates and a SIMD edge/depth test does not make it faster.
+	*
+	* Pixels are processed by groups of 4 while the whole group lies in [bx, lx[ and the
+	* remaining pixels are handled by the generic code. The scanline stops as soon as one
+	* lane exits the triangle since, starting from bx, the pixels inside the triangle always
+	* form a contiguous run.
+	**/
+	template<typename color_t, typename raw_t> struct SpanKernelSIMD : public SpanKernelScalar<color_t>
+		{
+
+		using SpanKernelScalar<color_t>::flat_zbuffer; // plain C++ version for non-float zbuffers
+		using SpanKernelScalar<color_t>::flat_zbuffer_full; // plain C++ version for non-float zbuffers
+
+
+		/** flat shading, no depth test */
+		static TGX_INLINE void flat(color_t* buf, int32_t bx, const int32_t lx,
+			int32_t C2, int32_t C3, const int32_t dx2, const int32_t dx3,
+			const color_t col)
+			{
+			raw_t* rbuf = (raw_t*)buf;
+			const raw_t rcol = (raw_t)col.val;
+			SpanSIMD::vint vC2 = SpanSIMD::ramp(C2, dx2);
+			SpanSIMD::vint vC3 = SpanSIMD::ramp(C3, dx3);
+			const SpanSIMD::vint d2 = SpanSIMD::splat(4 * dx2);
+			const SpanSIMD::vint d3 = SpanSIMD::splat(4 * dx3);
+			while (bx + 4 <= lx)
+				{
+				const SpanSIMD::vmask m = SpanSIMD::inside(vC2, vC3);
+				SpanSIMD::store(m, rbuf + bx, rcol);
+				if (SpanSIMD::bits(m) != 15) return; // end of the span
+				vC2 = SpanSIMD::add(vC2, d2);
+				vC3 = SpanSIMD::add(vC3, d3);
+				C2 += 4 * dx2;
+				C3 += 4 * dx3;
+				bx += 4;
+				}
+			SpanKernelScalar<color_t>::flat(buf, bx, lx, C2, C3, dx2, dx3, col);
+			}
+
+
+		/** flat shading with depth test (float zbuffer) */
+		template<typename RASTERIZER_PARAMS>
+		static TGX_INLINE void flat_zbuffer(color_t* buf, float* zbuf, int32_t bx, const int32_t lx,
+			int32_t C2, int32_t C3, const int32_t dx2, const int32_t dx3,
+			float cw, const float dw, const RASTERIZER_PARAMS& data,
+			const color_t col)
+			{
+			raw_t* rbuf = (raw_t*)buf;
+			const raw_t rcol = (raw_t)col.val;
+			SpanSIMD::vint vC2 = SpanSIMD::ramp(C2, dx2);
+			SpanSIMD::vint vC3 = SpanSIMD::ramp(C3, dx3);
+			const SpanSIMD::vint d2 = SpanSIMD::splat(4 * dx2);
+			const SpanSIMD::vint d3 = SpanSIMD::splat(4 * dx3);
+			SpanSIMD::vfloat vW = SpanSIMD::wramp(cw, dw);
+			const SpanSIMD::vfloat dW = SpanSIMD::splat(4 * dw);
+			while (bx + 4 <= lx)
+				{
+				const SpanSIMD::vmask m = SpanSIMD::inside(vC2, vC3);
+				const SpanSIMD::vmask mw = SpanSIMD::depth(m, zbuf + bx, vW);
+				TGX_STAT(data.stat_tested += SpanSIMD::count(m));
+				TGX_STAT(data.stat_passed += SpanSIMD::count(mw));
+				if (SpanSIMD::bits(mw)) data.zpassed = true;
+				SpanSIMD::store(mw, rbuf + bx, rcol);
+				if (SpanSIMD::bits(m) != 15) return; // end of the span
+				vC2 = SpanSIMD::add(vC2, d2);
+				vC3 = SpanSIMD::add(vC3, d3);
+				vW = SpanSIMD::add(vW, dW);
+				C2 += 4 * dx2;
+				C3 += 4 * dx3;
+				cw += 4 * dw;
+				bx += 4;
+				}
+			SpanKernelScalar<color_t>::flat_zbuffer(buf, zbuf, bx, lx, C2, C3, dx2, dx3, cw, dw, data, col);
+			}
+
+
+		/** flat shading of the span [0, lx[ entirely inside the triangle, no depth test */
+		static TGX_INLINE void flat_full(color_t* buf, const int32_t lx, const color_t col)
+			{
+			raw_t* rbuf = (raw_t*)buf;
+			const raw_t rcol = (raw_t)col.val;
+			int32_t bx = 0;
+			while (bx + 4 <= lx)
+				{
+				SpanSIMD::fill(rbuf + bx, rcol);
+				bx += 4;
+				}
+			SpanKernelScalar<color_t>::flat_full(buf + bx, lx - bx, col);
+			}
+
+
+		/** flat shading with depth test (float zbuffer) of the span [0, lx[ entirely inside the triangle */
+		template<typename RASTERIZER_PARAMS>
+		static TGX_INLINE void flat_zbuffer_full(color_t* buf, float* zbuf, const int32_t lx,
+			float cw, const float dw, const RASTERIZER_PARAMS& data,
+			const color_t col)
+			{
+			raw_t* rbuf = (raw_t*)buf;
+			const raw_t rcol = (raw_t)col.val;
+			const SpanSIMD::vmask m = SpanSIMD::all();
+			SpanSIMD::vfloat vW = SpanSIMD::wramp(cw, dw);
+			const SpanSIMD::vfloat dW = SpanSIMD::splat(4 * dw);
+			int32_t bx = 0;
+			while (bx + 4 <= lx)
+				{
+				const SpanSIMD::vmask mw = SpanSIMD::depth(m, zbuf + bx, vW);
+				TGX_STAT(data.stat_tested += 4);
+				TGX_STAT(data.stat_passed += SpanSIMD::count(mw));
+				if (SpanSIMD::bits(mw))
+					{
+					data.zpassed = true;
+					SpanSIMD::store(mw, rbuf + bx, rcol);
+					}
+				vW = SpanSIMD::add(vW, dW);
+				cw += 4 * dw;
+				bx += 4;
+				}
+			SpanKernelScalar<color_t>::flat_zbuffer_full(buf + bx, zbuf + bx, lx - bx, cw, dw, data, col);
+			}
+
+		};
+
+
+	/** RGB565 uses the SIMD span kernels */
+	template<> struct SpanKernel<RGB565> : public SpanKernelSIMD<RGB565, uint16_t> {};
+
+
+	/** RGB32 uses the SIMD span kernels */
+	template<> struct SpanKernel<RGB32> : public SpanKernelSIMD<RGB32, uint32_t> {};
+
+
+#endif
+
+
+}
+
+#endif
+
+#endif
+
+
+/** end of file */
+
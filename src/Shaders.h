@@ -23,6 +23,7 @@
 
 
 #include "ShaderParams.h"
+#include "ShaderSpans.h"
 
 namespace tgx
 {
@@ -32,12 +33,12 @@ namespace tgx
 	/**
 	* FLAT SHADING (NO ZBUFFER)
 	**/
-	template<typename color_t>
+	template<typename color_t, typename ZBUFFER_t>
 	void shader_Flat(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t& dx1, const int32_t& dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t& dx2, const int32_t& dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t& dx3, const int32_t& dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		color_t col = (color_t)data.facecolor;
 		color_t* buf = data.im->data() + offset;
@@ -45,6 +46,16 @@ namespace tgx
 
 		const uintptr_t end = (uintptr_t)(buf + (ly * stride));
 
+		if ((TGX_RASTERIZE_BLOCKS) && (rectInsideTriangle(lx, ly, dx1, dy1, O1, dx2, dy2, O2, dx3, dy3, O3)))
+			{ // run of fully covered blocks: no edge test
+			while ((uintptr_t)(buf) < end)
+				{
+				SpanKernel<color_t>::flat_full(buf, lx, col);
+				buf += stride;
+				}
+			return;
+			}
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -84,15 +95,9 @@ namespace tgx
 				bx = max(bx, ((-O3 + dx3 - 1) / dx3));
 				}
 
-			int32_t C2 = O2 + (dx2 * bx);
-			int32_t C3 = O3 + (dx3 * bx);
-			while ((bx < lx) && ((C2 | C3) >= 0))
-				{
-				buf[bx] = col;
-				C2 += dx2;
-				C3 += dx3;
-				bx++;
-				}
+			const int32_t C2 = O2 + (dx2 * bx);
+			const int32_t C3 = O3 + (dx3 * bx);
+			SpanKernel<color_t>::flat(buf, bx, lx, C2, C3, dx2, dx3, col);
 
 			O1 += dy1;
 			O2 += dy2;
@@ -106,12 +111,12 @@ namespace tgx
 	/**
 	* GOURAUD SHADING (NO Z BUFFER)
 	**/
-	template<typename color_t>
+	template<typename color_t, typename ZBUFFER_t>
 	void shader_Gouraud(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t& dx1, const int32_t& dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t& dx2, const int32_t& dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t& dx3, const int32_t& dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		color_t* buf = data.im->data() + offset;
 		const int32_t stride = data.im->stride();
@@ -123,6 +128,9 @@ namespace tgx
 		const uintptr_t end = (uintptr_t)(buf + (ly * stride));
 		const int32_t aera = O1 + O2 + O3;
 
+		GouraudGradient<color_t> grad;
+		grad.setup(col1, col2, col3, aera, dx2, dx3);
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -164,11 +172,13 @@ namespace tgx
 
 			int32_t C2 = O2 + (dx2 * bx);
 			int32_t C3 = O3 + (dx3 * bx);
+			grad.begin(C2, C3);
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
-				buf[bx] = blend(col2, C2, col3, C3, col1, aera);
+				buf[bx] = grad.color();
 				C2 += dx2;
 				C3 += dx3;
+				grad.step();
 				bx++;
 				}
 
@@ -184,12 +194,12 @@ namespace tgx
 	/**
 	* TEXTURE + FLAT SHADING (NO ZBUFFER)
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Flat_Texture(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
         
@@ -234,6 +244,9 @@ namespace tgx
 		const float dtx = ((T1.x * dx1) + (T2.x * dx2) + (T3.x * dx3));
 		const float dty = ((T1.y * dx1) + (T2.y * dx2) + (T3.y * dx3));
 
+		TexSubspan ts;
+		ts.setup(data.tex_subspan, data.tex_subspan_maxerr, dtx, dty, dw);
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -280,31 +293,31 @@ namespace tgx
 
 			float tx = ((T1.x * C1) + (T2.x * C2) + (T3.x * C3));
 			float ty = ((T1.y * C1) + (T2.y * C2) + (T3.y * C3));
+			ts.begin(tx, ty, cw);
 
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
-				const float icw = 1.0f / cw;
+				float xx, yy;
+				ts.texcoord(tx, ty, cw, xx, yy);
                                 
                 color_t col;
                 if (TEXTURE_BILINEAR)
                     {
-                    const float xx = tx * icw;
-                    const float yy = ty * icw;                    
                     const int ttx = (int)floorf(xx);
                     const int tty = (int)floorf(yy);
                     const float ax = xx - ttx;
                     const float ay = yy - tty;                    
                     const int minx = ttx & (texsize_x);
                     const int maxx = (ttx + 1) & (texsize_x);
-                    const int miny = (tty & (texsize_y))*texstride;
-                    const int maxy = ((tty + 1) & (texsize_y))*texstride;                  
-                    col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                    const int miny = tty & (texsize_y);
+                    const int maxy = (tty + 1) & (texsize_y);                  
+                    col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                     }
                 else
                     {
-                    const int ttx = ((int)((tx * icw))) & (texsize_x);
-                    const int tty = ((int)((ty * icw))) & (texsize_y);
-                    col = tex[ttx + (tty)*texstride];
+                    const int ttx = ((int)xx) & (texsize_x);
+                    const int tty = ((int)yy) & (texsize_y);
+                    col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];
                     }                  
                                 
 				col.mult256(fPR, fPG, fPB);
@@ -316,6 +329,7 @@ namespace tgx
 
 				tx += dtx;
 				ty += dty;
+				ts.step(tx, ty, cw);
 
 				bx++;
 				}
@@ -332,12 +346,12 @@ namespace tgx
 	/**
 	* TEXTURE + GOURAUD SHADING (NO ZBUFFER)
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Gouraud_Texture(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
         
@@ -361,15 +375,10 @@ namespace tgx
 		const RGBf& cf1 = (RGBf)fP1.color;
 		const RGBf& cf2 = (RGBf)fP2.color;
 		const RGBf& cf3 = (RGBf)fP3.color;
-		const int fP1R = (int)(256 * cf1.R);
-		const int fP1G = (int)(256 * cf1.G);
-		const int fP1B = (int)(256 * cf1.B);
-		const int fP21R = (int)(256 * (cf2.R - cf1.R));
-		const int fP21G = (int)(256 * (cf2.G - cf1.G));
-		const int fP21B = (int)(256 * (cf2.B - cf1.B));
-		const int fP31R = (int)(256 * (cf3.R - cf1.R));
-		const int fP31G = (int)(256 * (cf3.G - cf1.G));
-		const int fP31B = (int)(256 * (cf3.B - cf1.B));
+		FixedGradient3<16> grad; // light intensity (x256) for each channel
+		grad.setup(256 * cf1.R, 256 * cf1.G, 256 * cf1.B,
+				   256 * cf2.R, 256 * cf2.G, 256 * cf2.B,
+				   256 * cf3.R, 256 * cf3.G, 256 * cf3.B, aera, dx2, dx3);
 
 		// the texture coord
 		fVec2 T1 = fP1.T;
@@ -391,6 +400,9 @@ namespace tgx
 		const float dtx = ((T1.x * dx1) + (T2.x * dx2) + (T3.x * dx3));
 		const float dty = ((T1.y * dx1) + (T2.y * dx2) + (T3.y * dx3));
 
+		TexSubspan ts;
+		ts.setup(data.tex_subspan, data.tex_subspan_maxerr, dtx, dty, dw);
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -433,50 +445,49 @@ namespace tgx
 			int32_t C1 = O1 + (dx1 * bx);
 			int32_t C2 = O2 + (dx2 * bx);
 			int32_t C3 = O3 + (dx3 * bx);
+			grad.begin(C2, C3);
 			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
 
 			float tx = ((T1.x * C1) + (T2.x * C2) + (T3.x * C3));
 			float ty = ((T1.y * C1) + (T2.y * C2) + (T3.y * C3));
+			ts.begin(tx, ty, cw);
 
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
-				const float icw = 1.0f / cw;
+				float xx, yy;
+				ts.texcoord(tx, ty, cw, xx, yy);
                 
                 color_t col;
                 if (TEXTURE_BILINEAR)
                     {
-                    const float xx = tx * icw;
-                    const float yy = ty * icw;                    
                     const int ttx = (int)floorf(xx);
                     const int tty = (int)floorf(yy);
                     const float ax = xx - ttx;
                     const float ay = yy - tty;                    
                     const int minx = ttx & (texsize_x);
                     const int maxx = (ttx + 1) & (texsize_x);
-                    const int miny = (tty & (texsize_y))*texstride;
-                    const int maxy = ((tty + 1) & (texsize_y))*texstride;                  
-                    col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                    const int miny = tty & (texsize_y);
+                    const int maxy = (tty + 1) & (texsize_y);                  
+                    col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                     }
                 else
                     {
-                    const int ttx = ((int)((tx * icw))) & (texsize_x);
-                    const int tty = ((int)((ty * icw))) & (texsize_y);
-                    col = tex[ttx + (tty)*texstride];
+                    const int ttx = ((int)xx) & (texsize_x);
+                    const int tty = ((int)yy) & (texsize_y);
+                    col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];
                     }
                     
-				const int r = fP1R + ((C2 * fP21R + C3 * fP31R) / aera);
-				const int g = fP1G + ((C2 * fP21G + C3 * fP31G) / aera);
-				const int b = fP1B + ((C2 * fP21B + C3 * fP31B) / aera);
-
-				col.mult256(r, g, b);
+				col.mult256(grad.R(), grad.G(), grad.B());
 				buf[bx] = col;
 
 				C2 += dx2;
 				C3 += dx3;
+				grad.step();
 				cw += dw;
 
 				tx += dtx;
 				ty += dty;
+				ts.step(tx, ty, cw);
 
 				bx++;
 				}
@@ -493,28 +504,43 @@ namespace tgx
 	/**
 	* ZBUFFER + FLAT SHADING
 	**/
-	template<typename color_t> void shader_Flat_Zbuffer(const int32_t offset, const int32_t& lx, const int32_t& ly,
+	template<typename color_t, typename ZBUFFER_t> void shader_Flat_Zbuffer(const int32_t offset, const int32_t& lx, const int32_t& ly,
 		const int32_t& dx1, const int32_t& dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t& dx2, const int32_t& dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t& dx3, const int32_t& dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t col = (color_t)data.facecolor;
 		color_t* buf = data.im->data() + offset;
-		float* zbuf = data.zbuf + offset;
+		ZBUFFER_t* zbuf = data.zbuf + offset;
 
 		const int32_t stride = data.im->stride();
-		const int32_t zstride = data.im->lx();
+		const int32_t zstride = data.im->stride();
 
 		const uintptr_t end = (uintptr_t)(buf + (ly * stride));
 		const int32_t aera = O1 + O2 + O3;
 
 		const float invaera = 1.0f / aera;
-		const float fP1a = fP1.w * invaera;
-		const float fP2a = fP2.w * invaera;
-		const float fP3a = fP3.w * invaera;
+		const float fP1a = (fP1.w + data.zoff) * data.zmul * invaera;
+		const float fP2a = (fP2.w + data.zoff) * data.zmul * invaera;
+		const float fP3a = (fP3.w + data.zoff) * data.zmul * invaera;
 		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
 
+		if ((TGX_RASTERIZE_BLOCKS) && (rectInsideTriangle(lx, ly, dx1, dy1, O1, dx2, dy2, O2, dx3, dy3, O3)))
+			{ // run of fully covered blocks: no edge test
+			while ((uintptr_t)(buf) < end)
+				{
+				const float cw = ((O1 * fP1a) + (O2 * fP2a) + (O3 * fP3a));
+				SpanKernel<color_t>::flat_zbuffer_full(buf, zbuf, lx, cw, dw, data, col);
+				O1 += dy1;
+				O2 += dy2;
+				O3 += dy3;
+				buf += stride;
+				zbuf += zstride;
+				}
+			return;
+			}
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -557,23 +583,10 @@ namespace tgx
 				}
 
 			const int32_t C1 = O1 + (dx1 * bx);
-			int32_t C2 = O2 + (dx2 * bx);
-			int32_t C3 = O3 + (dx3 * bx);
-			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
-
-			while ((bx < lx) && ((C2 | C3) >= 0))
-				{
-				float& W = zbuf[bx];
-				if (W < cw)
-					{
-					W = cw;
-					buf[bx] = col;
-					}
-				C2 += dx2;
-				C3 += dx3;
-				cw += dw;
-				bx++;
-				}
+			const int32_t C2 = O2 + (dx2 * bx);
+			const int32_t C3 = O3 + (dx3 * bx);
+			const float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
+			SpanKernel<color_t>::flat_zbuffer(buf, zbuf, bx, lx, C2, C3, dx2, dx3, cw, dw, data, col);
 
 			O1 += dy1;
 			O2 += dy2;
@@ -588,18 +601,18 @@ namespace tgx
 	/**
 	* ZBUFFER + GOURAUD SHADING
 	**/
-	template<typename color_t>
+	template<typename color_t, typename ZBUFFER_t>
 	void shader_Gouraud_Zbuffer(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		color_t* buf = data.im->data() + offset;
-		float* zbuf = data.zbuf + offset;
+		ZBUFFER_t* zbuf = data.zbuf + offset;
 
 		const int32_t stride = data.im->stride();
-		const int32_t zstride = data.im->lx();
+		const int32_t zstride = data.im->stride();
 
 		const color_t col1 = (color_t)fP1.color;
 		const color_t col2 = (color_t)fP2.color;
@@ -609,11 +622,14 @@ namespace tgx
 		const int32_t aera = O1 + O2 + O3;
 
 		const float invaera = 1.0f / aera;
-		const float fP1a = fP1.w * invaera;
-		const float fP2a = fP2.w * invaera;
-		const float fP3a = fP3.w * invaera;
+		const float fP1a = (fP1.w + data.zoff) * data.zmul * invaera;
+		const float fP2a = (fP2.w + data.zoff) * data.zmul * invaera;
+		const float fP3a = (fP3.w + data.zoff) * data.zmul * invaera;
 		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
 
+		GouraudGradient<color_t> grad;
+		grad.setup(col1, col2, col3, aera, dx2, dx3);
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -656,23 +672,11 @@ namespace tgx
 				}
 
 			const int32_t C1 = O1 + (dx1 * bx);
-			int32_t C2 = O2 + (dx2 * bx);
-			int32_t C3 = O3 + (dx3 * bx);
-			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
-
-			while ((bx < lx) && ((C2 | C3) >= 0))
-				{
-				float& W = zbuf[bx];
-				if (W < cw)
-					{
-					W = cw;
-					buf[bx] = blend(col2, C2, col3, C3, col1, aera);
-					}
-				C2 += dx2;
-				C3 += dx3;
-				cw += dw;
-				bx++;
-				}
+			const int32_t C2 = O2 + (dx2 * bx);
+			const int32_t C3 = O3 + (dx3 * bx);
+			const float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
+			grad.begin(C2, C3);
+			SpanKernel<color_t>::gouraud_zbuffer(buf, zbuf, bx, lx, C2, C3, dx2, dx3, cw, dw, data, grad);
 
 			O1 += dy1;
 			O2 += dy2;
@@ -687,12 +691,12 @@ namespace tgx
 	/**
 	* ZBUFFER + TEXTURE + FLAT SHADING
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Flat_Texture_Zbuffer(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
         
@@ -701,18 +705,18 @@ namespace tgx
         const int32_t texstride = data.tex->stride();
         
 		color_t* buf = data.im->data() + offset;
-		float* zbuf = data.zbuf + offset;
+		ZBUFFER_t* zbuf = data.zbuf + offset;
 
 		const int32_t stride = data.im->stride();
-		const int32_t zstride = data.im->lx();
+		const int32_t zstride = data.im->stride();
 
 		const uintptr_t end = (uintptr_t)(buf + (ly * stride));
 		const int32_t aera = O1 + O2 + O3;
 
 		const float invaera = 1.0f / aera;
-		const float fP1a = fP1.w * invaera;
-		const float fP2a = fP2.w * invaera;
-		const float fP3a = fP3.w * invaera;
+		const float fP1a = (fP1.w + data.zoff) * data.zmul * invaera;
+		const float fP2a = (fP2.w + data.zoff) * data.zmul * invaera;
+		const float fP3a = (fP3.w + data.zoff) * data.zmul * invaera;
 
 		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
 
@@ -741,6 +745,9 @@ namespace tgx
 		const float dtx = ((T1.x * dx1) + (T2.x * dx2) + (T3.x * dx3));
 		const float dty = ((T1.y * dx1) + (T2.y * dx2) + (T3.y * dx3));
 
+		TexSubspan ts;
+		ts.setup(data.tex_subspan, data.tex_subspan_maxerr, dtx, dty, dw);
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -789,34 +796,32 @@ namespace tgx
 
 			float tx = ((T1.x * C1) + (T2.x * C2) + (T3.x * C3));
 			float ty = ((T1.y * C1) + (T2.y * C2) + (T3.y * C3));
+			ts.begin(tx, ty, cw);
 
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
-				float& W = zbuf[bx];
-				if (W < cw)
+				if (depthTest(zbuf[bx], cw, data))
 					{
-					W = cw;
-					const float icw = 1.0f / cw;
+					float xx, yy;
+					ts.texcoord(tx, ty, cw, xx, yy);
                     color_t col;
                     if (TEXTURE_BILINEAR)
                         {
-                        const float xx = tx * icw;
-                        const float yy = ty * icw;                    
                         const int ttx = (int)floorf(xx);
                         const int tty = (int)floorf(yy);
                         const float ax = xx - ttx;
                         const float ay = yy - tty;                    
                         const int minx = ttx & (texsize_x);
                         const int maxx = (ttx + 1) & (texsize_x);
-                        const int miny = (tty & (texsize_y))*texstride;
-                        const int maxy = ((tty + 1) & (texsize_y))*texstride;                  
-                        col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                        const int miny = tty & (texsize_y);
+                        const int maxy = (tty + 1) & (texsize_y);                  
+                        col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                         }
                     else
                         {
-                        const int ttx = ((int)((tx * icw))) & (texsize_x);
-                        const int tty = ((int)((ty * icw))) & (texsize_y);
-                        col = tex[ttx + (tty)*texstride];                           
+                        const int ttx = ((int)xx) & (texsize_x);
+                        const int tty = ((int)yy) & (texsize_y);
+                        col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];                           
                         }  
                     
 					col.mult256(fPR, fPG, fPB);
@@ -829,6 +834,7 @@ namespace tgx
 
 				tx += dtx;
 				ty += dty;
+				ts.step(tx, ty, cw);
 
 				bx++;
 				}
@@ -846,12 +852,12 @@ namespace tgx
 	/**
 	* ZBUFFER + TEXTURE + GOURAUD SHADING
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Gouraud_Texture_Zbuffer(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
         
@@ -860,33 +866,28 @@ namespace tgx
         const int32_t texstride = data.tex->stride();
         
 		color_t* buf = data.im->data() + offset;
-		float* zbuf = data.zbuf + offset;
+		ZBUFFER_t* zbuf = data.zbuf + offset;
 
 		const int32_t stride = data.im->stride();
-		const int32_t zstride = data.im->lx();
+		const int32_t zstride = data.im->stride();
 
 		const uintptr_t end = (uintptr_t)(buf + (ly * stride));
 		const int32_t aera = O1 + O2 + O3;
 
 		const float invaera = 1.0f / aera;
-		const float fP1a = fP1.w * invaera;
-		const float fP2a = fP2.w * invaera;
-		const float fP3a = fP3.w * invaera;
+		const float fP1a = (fP1.w + data.zoff) * data.zmul * invaera;
+		const float fP2a = (fP2.w + data.zoff) * data.zmul * invaera;
+		const float fP3a = (fP3.w + data.zoff) * data.zmul * invaera;
 
 		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
 
 		const RGBf& cf1 = (RGBf)fP1.color;
 		const RGBf& cf2 = (RGBf)fP2.color;
 		const RGBf& cf3 = (RGBf)fP3.color;
-		const int fP1R = (int)(256 * cf1.R);
-		const int fP1G = (int)(256 * cf1.G);
-		const int fP1B = (int)(256 * cf1.B);
-		const int fP21R = (int)(256 * (cf2.R - cf1.R));
-		const int fP21G = (int)(256 * (cf2.G - cf1.G));
-		const int fP21B = (int)(256 * (cf2.B - cf1.B));
-		const int fP31R = (int)(256 * (cf3.R - cf1.R));
-		const int fP31G = (int)(256 * (cf3.G - cf1.G));
-		const int fP31B = (int)(256 * (cf3.B - cf1.B));
+		FixedGradient3<16> grad; // light intensity (x256) for each channel
+		grad.setup(256 * cf1.R, 256 * cf1.G, 256 * cf1.B,
+				   256 * cf2.R, 256 * cf2.G, 256 * cf2.B,
+				   256 * cf3.R, 256 * cf3.G, 256 * cf3.B, aera, dx2, dx3);
 
 		// the texture coord
 		fVec2 T1 = fP1.T;
@@ -907,6 +908,9 @@ namespace tgx
 		const float dtx = ((T1.x * dx1) + (T2.x * dx2) + (T3.x * dx3));
 		const float dty = ((T1.y * dx1) + (T2.y * dx2) + (T3.y * dx3));
 
+		TexSubspan ts;
+		ts.setup(data.tex_subspan, data.tex_subspan_maxerr, dtx, dty, dw);
+
 		while ((uintptr_t)(buf) < end)
 			{ // iterate over scanlines
 			int32_t bx = 0; // start offset
@@ -950,54 +954,52 @@ namespace tgx
 			int32_t C1 = O1 + (dx1 * bx);
 			int32_t C2 = O2 + (dx2 * bx);
 			int32_t C3 = O3 + (dx3 * bx);
+			grad.begin(C2, C3);
 			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
 
 			float tx = ((T1.x * C1) + (T2.x * C2) + (T3.x * C3));
 			float ty = ((T1.y * C1) + (T2.y * C2) + (T3.y * C3));
+			ts.begin(tx, ty, cw);
 
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
-				float& W = zbuf[bx];
-				if (W < cw)
+				if (depthTest(zbuf[bx], cw, data))
 					{
-					W = cw;
-					const float icw = 1.0f / cw;
+					float xx, yy;
+					ts.texcoord(tx, ty, cw, xx, yy);
 
                     color_t col;
                     if (TEXTURE_BILINEAR)
                         {
-                        const float xx = tx * icw;
-                        const float yy = ty * icw;                    
                         const int ttx = (int)floorf(xx);
                         const int tty = (int)floorf(yy);
                         const float ax = xx - ttx;
                         const float ay = yy - tty;                    
                         const int minx = ttx & (texsize_x);
                         const int maxx = (ttx + 1) & (texsize_x);
-                        const int miny = (tty & (texsize_y))*texstride;
-                        const int maxy = ((tty + 1) & (texsize_y))*texstride;
-                        col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                        const int miny = tty & (texsize_y);
+                        const int maxy = (tty + 1) & (texsize_y);
+                        col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                         }
                     else
                         {
-                        const int ttx = ((int)((tx * icw))) & (texsize_x);
-                        const int tty = ((int)((ty * icw))) & (texsize_y);
-                        col = tex[ttx + (tty)*texstride];
+                        const int ttx = ((int)xx) & (texsize_x);
+                        const int tty = ((int)yy) & (texsize_y);
+                        col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];
                         }  
 
-					const int r = fP1R + ((C2 * fP21R + C3 * fP31R) / aera);
-					const int g = fP1G + ((C2 * fP21G + C3 * fP31G) / aera);
-					const int b = fP1B + ((C2 * fP21B + C3 * fP31B) / aera);
-					col.mult256(r, g, b);
+					col.mult256(grad.R(), grad.G(), grad.B());
 					buf[bx] = col;
 					}
 
 				C2 += dx2;
 				C3 += dx3;
+				grad.step();
 				cw += dw;
 
 				tx += dtx;
 				ty += dty;
+				ts.step(tx, ty, cw);
 
 				bx++;
 				}
@@ -1015,12 +1017,12 @@ namespace tgx
 	/**
 	* TEXTURE + FLAT SHADING (NO ZBUFFER) + ORTHOGRAPHIC
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Flat_Texture_Ortho(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
         
@@ -1119,15 +1121,15 @@ namespace tgx
                     const float ay = yy - tty;                    
                     const int minx = ttx & (texsize_x);
                     const int maxx = (ttx + 1) & (texsize_x);
-                    const int miny = (tty & (texsize_y))*texstride;
-                    const int maxy = ((tty + 1) & (texsize_y))*texstride;                  
-                    col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                    const int miny = tty & (texsize_y);
+                    const int maxy = (tty + 1) & (texsize_y);                  
+                    col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                     }
                 else
                     {
                     const int ttx = ((int)((tx))) & (texsize_x);
                     const int tty = ((int)((ty))) & (texsize_y);
-                    col = tex[ttx + (tty)*texstride];
+                    col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];
                     }  
                         
                 col.mult256(fPR, fPG, fPB);
@@ -1154,12 +1156,12 @@ namespace tgx
 	/**
 	* TEXTURE + GOURAUD SHADING (NO ZBUFFER) + ORTHOGRAPHIC
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Gouraud_Texture_Ortho(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
 		const int32_t texsize_x = data.tex->width() - 1;
@@ -1177,15 +1179,10 @@ namespace tgx
 		const RGBf& cf1 = (RGBf)fP1.color;
 		const RGBf& cf2 = (RGBf)fP2.color;
 		const RGBf& cf3 = (RGBf)fP3.color;
-		const int fP1R = (int)(256 * cf1.R);
-		const int fP1G = (int)(256 * cf1.G);
-		const int fP1B = (int)(256 * cf1.B);
-		const int fP21R = (int)(256 * (cf2.R - cf1.R));
-		const int fP21G = (int)(256 * (cf2.G - cf1.G));
-		const int fP21B = (int)(256 * (cf2.B - cf1.B));
-		const int fP31R = (int)(256 * (cf3.R - cf1.R));
-		const int fP31G = (int)(256 * (cf3.G - cf1.G));
-		const int fP31B = (int)(256 * (cf3.B - cf1.B));
+		FixedGradient3<16> grad; // light intensity (x256) for each channel
+		grad.setup(256 * cf1.R, 256 * cf1.G, 256 * cf1.B,
+				   256 * cf2.R, 256 * cf2.G, 256 * cf2.B,
+				   256 * cf3.R, 256 * cf3.G, 256 * cf3.B, aera, dx2, dx3);
 
 		// the texture coord
 		fVec2 T1 = fP1.T;
@@ -1248,6 +1245,7 @@ namespace tgx
 			int32_t C1 = O1 + (dx1 * bx);
 			int32_t C2 = O2 + (dx2 * bx);
 			int32_t C3 = O3 + (dx3 * bx);
+			grad.begin(C2, C3);
 
 			float tx = ((T1.x * C1) + (T2.x * C2) + (T3.x * C3));
 			float ty = ((T1.y * C1) + (T2.y * C2) + (T3.y * C3));
@@ -1266,25 +1264,23 @@ namespace tgx
                     const float ay = yy - tty;                    
                     const int minx = ttx & (texsize_x);
                     const int maxx = (ttx + 1) & (texsize_x);
-                    const int miny = (tty & (texsize_y))*texstride;
-                    const int maxy = ((tty + 1) & (texsize_y))*texstride;                  
-                    col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                    const int miny = tty & (texsize_y);
+                    const int maxy = (tty + 1) & (texsize_y);                  
+                    col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                     }
                 else
                     {
                     const int ttx = ((int)((tx))) & (texsize_x);
                     const int tty = ((int)((ty))) & (texsize_y);
-                    col = tex[ttx + (tty)*texstride];
+                    col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];
                     }
                            
-                const int r = fP1R + ((C2 * fP21R + C3 * fP31R) / aera);
-				const int g = fP1G + ((C2 * fP21G + C3 * fP31G) / aera);
-				const int b = fP1B + ((C2 * fP21B + C3 * fP31B) / aera);
-				col.mult256(r, g, b);
+                col.mult256(grad.R(), grad.G(), grad.B());
 				buf[bx] = col;
 
 				C2 += dx2;
 				C3 += dx3;
+				grad.step();
 
 				tx += dtx;
 				ty += dty;
@@ -1304,12 +1300,12 @@ namespace tgx
 	/**
 	* ZBUFFER + TEXTURE + FLAT SHADING + ORTHOGRAPHIC
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Flat_Texture_Zbuffer_Ortho(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
 
@@ -1318,18 +1314,18 @@ namespace tgx
         const int32_t texstride = data.tex->stride();
 
 		color_t* buf = data.im->data() + offset;
-		float* zbuf = data.zbuf + offset;
+		ZBUFFER_t* zbuf = data.zbuf + offset;
 
 		const int32_t stride = data.im->stride();
-		const int32_t zstride = data.im->lx();
+		const int32_t zstride = data.im->stride();
 
 		const uintptr_t end = (uintptr_t)(buf + (ly * stride));
 		const int32_t aera = O1 + O2 + O3;
 
 		const float invaera = 1.0f / aera;
-		const float fP1a = fP1.w * invaera;
-		const float fP2a = fP2.w * invaera;
-		const float fP3a = fP3.w * invaera;
+		const float fP1a = (fP1.w + data.zoff) * data.zmul * invaera;
+		const float fP2a = (fP2.w + data.zoff) * data.zmul * invaera;
+		const float fP3a = (fP3.w + data.zoff) * data.zmul * invaera;
 
 		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
 
@@ -1409,10 +1405,8 @@ namespace tgx
 
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
-				float& W = zbuf[bx];
-				if (W < cw)
+				if (depthTest(zbuf[bx], cw, data))
 					{
-					W = cw;
                                                       
                     color_t col;
                     if (TEXTURE_BILINEAR)
@@ -1425,15 +1419,15 @@ namespace tgx
                         const float ay = yy - tty;                    
                         const int minx = ttx & (texsize_x);
                         const int maxx = (ttx + 1) & (texsize_x);
-                        const int miny = (tty & (texsize_y))*texstride;
-                        const int maxy = ((tty + 1) & (texsize_y))*texstride;                  
-                        col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                        const int miny = tty & (texsize_y);
+                        const int maxy = (tty + 1) & (texsize_y);                  
+                        col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                         }
                     else
                         {
                         const int ttx = ((int)((tx))) & (texsize_x);
                         const int tty = ((int)((ty))) & (texsize_y);
-                        col = tex[ttx + (tty)*texstride];
+                        col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];
                         }                            
                                                         
 					col.mult256(fPR, fPG, fPB);
@@ -1463,12 +1457,12 @@ namespace tgx
 	/**
 	* ZBUFFER + TEXTURE + GOURAUD SHADING + ORTHOGRAPHIC
 	**/
-	template<typename color_t, bool TEXTURE_BILINEAR>
+	template<typename color_t, typename ZBUFFER_t, bool TEXTURE_BILINEAR, bool TEXTURE_TILED>
 	void shader_Gouraud_Texture_Zbuffer_Ortho(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t>& data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
 		{
 		const color_t* tex = data.tex->data();
             
@@ -1477,33 +1471,28 @@ namespace tgx
         const int32_t texstride = data.tex->stride();            
 
 		color_t* buf = data.im->data() + offset;
-		float* zbuf = data.zbuf + offset;
+		ZBUFFER_t* zbuf = data.zbuf + offset;
 
 		const int32_t stride = data.im->stride();
-		const int32_t zstride = data.im->lx();
+		const int32_t zstride = data.im->stride();
 
 		const uintptr_t end = (uintptr_t)(buf + (ly * stride));
 		const int32_t aera = O1 + O2 + O3;
 
 		const float invaera = 1.0f / aera;
-		const float fP1a = fP1.w * invaera;
-		const float fP2a = fP2.w * invaera;
-		const float fP3a = fP3.w * invaera;
+		const float fP1a = (fP1.w + data.zoff) * data.zmul * invaera;
+		const float fP2a = (fP2.w + data.zoff) * data.zmul * invaera;
+		const float fP3a = (fP3.w + data.zoff) * data.zmul * invaera;
 
 		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
 
 		const RGBf& cf1 = (RGBf)fP1.color;
 		const RGBf& cf2 = (RGBf)fP2.color;
 		const RGBf& cf3 = (RGBf)fP3.color;
-		const int fP1R = (int)(256 * cf1.R);
-		const int fP1G = (int)(256 * cf1.G);
-		const int fP1B = (int)(256 * cf1.B);
-		const int fP21R = (int)(256 * (cf2.R - cf1.R));
-		const int fP21G = (int)(256 * (cf2.G - cf1.G));
-		const int fP21B = (int)(256 * (cf2.B - cf1.B));
-		const int fP31R = (int)(256 * (cf3.R - cf1.R));
-		const int fP31G = (int)(256 * (cf3.G - cf1.G));
-		const int fP31B = (int)(256 * (cf3.B - cf1.B));
+		FixedGradient3<16> grad; // light intensity (x256) for each channel
+		grad.setup(256 * cf1.R, 256 * cf1.G, 256 * cf1.B,
+				   256 * cf2.R, 256 * cf2.G, 256 * cf2.B,
+				   256 * cf3.R, 256 * cf3.G, 256 * cf3.B, aera, dx2, dx3);
 
 		// the texture coord
 		fVec2 T1 = fP1.T;
@@ -1568,6 +1557,7 @@ namespace tgx
 			int32_t C1 = O1 + (dx1 * bx);
 			int32_t C2 = O2 + (dx2 * bx);
 			int32_t C3 = O3 + (dx3 * bx);
+			grad.begin(C2, C3);
 			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
 
 			float tx = ((T1.x * C1) + (T2.x * C2) + (T3.x * C3));
@@ -1575,10 +1565,8 @@ namespace tgx
 
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
-				float& W = zbuf[bx];
-				if (W < cw)
+				if (depthTest(zbuf[bx], cw, data))
 					{
-					W = cw;
 
                     color_t col;
                     if (TEXTURE_BILINEAR)
@@ -1591,28 +1579,25 @@ namespace tgx
                         const float ay = yy - tty;                    
                         const int minx = ttx & (texsize_x);
                         const int maxx = (ttx + 1) & (texsize_x);
-                        const int miny = (tty & (texsize_y))*texstride;
-                        const int maxy = ((tty + 1) & (texsize_y))*texstride;                  
-                        col = blend_bilinear(tex[minx + miny], tex[maxx + miny], tex[minx + maxy], tex[maxx + maxy], ax, ay);                            
+                        const int miny = tty & (texsize_y);
+                        const int maxy = (tty + 1) & (texsize_y);                  
+                        col = blend_bilinear(tex[texelIndex<TEXTURE_TILED>(minx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, miny, texstride)], tex[texelIndex<TEXTURE_TILED>(minx, maxy, texstride)], tex[texelIndex<TEXTURE_TILED>(maxx, maxy, texstride)], ax, ay);                            
                         }
                     else
                         {
                         const int ttx = ((int)((tx))) & (texsize_x);
                         const int tty = ((int)((ty))) & (texsize_y);
-                        col = tex[ttx + (tty)*texstride];
+                        col = tex[texelIndex<TEXTURE_TILED>(ttx, tty, texstride)];
                         } 
                                 
-                    const int r = fP1R + ((C2 * fP21R + C3 * fP31R) / aera);
-					const int g = fP1G + ((C2 * fP21G + C3 * fP31G) / aera);
-					const int b = fP1B + ((C2 * fP21B + C3 * fP31B) / aera);
-
-					col.mult256(r, g, b);
+                    col.mult256(grad.R(), grad.G(), grad.B());
 					buf[bx] = col;
 
 					}
 
 				C2 += dx2;
 				C3 += dx3;
+				grad.step();
 				cw += dw;
 
 				tx += dtx;
@@ -1632,14 +1617,111 @@ namespace tgx
 
 
 
+	/**
+	* ZBUFFER + VISIBILITY BUFFER (DEFERRED RENDERING)
+	*
+	* Only perform the depth test and write the id data.vid of the triangle in the 
+	* visibility buffer data.vbuf (which has the same stride as the image). 
+	**/
+	template<typename color_t, typename ZBUFFER_t>
+	void shader_Visibility_Zbuffer(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
+		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
+		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
+		const RasterizerParams<color_t, color_t, ZBUFFER_t>& data)
+		{
+		const uint32_t id = data.vid;
+		uint32_t* vbuf = data.vbuf + offset;
+		ZBUFFER_t* zbuf = data.zbuf + offset;
+
+		const int32_t stride = data.im->stride();
+
+		const uint32_t* end = vbuf + (ly * stride);
+		const int32_t aera = O1 + O2 + O3;
+
+		const float invaera = 1.0f / aera;
+		const float fP1a = (fP1.w + data.zoff) * data.zmul * invaera;
+		const float fP2a = (fP2.w + data.zoff) * data.zmul * invaera;
+		const float fP3a = (fP3.w + data.zoff) * data.zmul * invaera;
+		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
+
+		while (vbuf < end)
+			{ // iterate over scanlines
+			int32_t bx = 0; // start offset
+			if (O1 < 0)
+				{
+				// we know that dx1 > 0					
+				bx = (-O1 + dx1 - 1) / dx1; // first index where it becomes positive
+				}
+			if (O2 < 0)
+				{
+				if (dx2 <= 0)
+					{
+					if (dy2 <= 0) return;
+					const int32_t by = (-O2 + dy2 - 1) / dy2;
+					O1 += (by * dy1);
+					O2 += (by * dy2);
+					O3 += (by * dy3);
+					const int32_t offs = by * stride;
+					vbuf += offs;
+					zbuf += offs;
+					continue;
+					}
+				bx = max(bx, ((-O2 + dx2 - 1) / dx2));
+				}
+			if (O3 < 0)
+				{
+				if (dx3 <= 0)
+					{
+					if (dy3 <= 0) return;
+					const int32_t by = (-O3 + dy3 - 1) / dy3;
+					O1 += (by * dy1);
+					O2 += (by * dy2);
+					O3 += (by * dy3);
+					const int32_t offs = by * stride;
+					vbuf += offs;
+					zbuf += offs;
+					continue;
+					}
+				bx = max(bx, ((-O3 + dx3 - 1) / dx3));
+				}
+
+			const int32_t C1 = O1 + (dx1 * bx);
+			int32_t C2 = O2 + (dx2 * bx);
+			int32_t C3 = O3 + (dx3 * bx);
+			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
+
+			while ((bx < lx) && ((C2 | C3) >= 0))
+				{
+				if (depthTest(zbuf[bx], cw, data))
+					{
+					vbuf[bx] = id;
+					}
+				C2 += dx2;
+				C3 += dx3;
+				cw += dw;
+				bx++;
+				}
+
+			O1 += dy1;
+			O2 += dy2;
+			O3 += dy3;
+			vbuf += stride;
+			zbuf += stride;
+			}
+		}
+
+
+
+
 	/**
 	* META-SHADER THAT DISPATCH TO THE CORRECT SHADER ABOVE.
 	**/
-	template<bool ZBUFFER, bool ORTHO, typename color_t> void shader_select(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+	template<bool ZBUFFER, bool ORTHO, typename color_t, typename ZBUFFER_t> void shader_select(const int32_t& offset, const int32_t& lx, const int32_t& ly,
 		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
 		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
-		const RasterizerParams<color_t, color_t> & data)
+		const RasterizerParams<color_t, color_t, ZBUFFER_t> & data)
 		{		
 		int raster_type = data.shader_type;       
 		if (ZBUFFER)
@@ -1650,25 +1732,45 @@ namespace tgx
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
                         {
-                        if (data.use_bilinear_texturing)                    
-                            shader_Gouraud_Texture_Zbuffer_Ortho<color_t, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Gouraud_Texture_Zbuffer_Ortho<color_t, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					else
                         {
-                        if (data.use_bilinear_texturing)                                                
-                            shader_Flat_Texture_Zbuffer_Ortho<color_t, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Flat_Texture_Zbuffer_Ortho<color_t, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture_Zbuffer_Ortho<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					}
 				else
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
-						shader_Gouraud_Zbuffer<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);  // same as perspective projection
+						shader_Gouraud_Zbuffer<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);  // same as perspective projection
 					else
-						shader_Flat_Zbuffer<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);  // same as perspective projection
+						shader_Flat_Zbuffer<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);  // same as perspective projection
 					}
 				}
 			else
@@ -1677,25 +1779,45 @@ namespace tgx
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
                         {
-                        if (data.use_bilinear_texturing)                    
-                            shader_Gouraud_Texture_Zbuffer<color_t, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture_Zbuffer<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture_Zbuffer<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Gouraud_Texture_Zbuffer<color_t, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture_Zbuffer<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture_Zbuffer<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					else
                         {
-                        if (data.use_bilinear_texturing)                    
-                            shader_Flat_Texture_Zbuffer<color_t, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture_Zbuffer<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture_Zbuffer<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Flat_Texture_Zbuffer<color_t, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture_Zbuffer<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture_Zbuffer<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					}
 				else
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
-						shader_Gouraud_Zbuffer<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						shader_Gouraud_Zbuffer<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
 					else
-						shader_Flat_Zbuffer<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						shader_Flat_Zbuffer<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
 					}
 				}
 			}
@@ -1707,25 +1829,45 @@ namespace tgx
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
                         {
-                        if (data.use_bilinear_texturing)                    
-                            shader_Gouraud_Texture_Ortho<color_t,true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture_Ortho<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture_Ortho<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Gouraud_Texture_Ortho<color_t,false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture_Ortho<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture_Ortho<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					else
                         {
-                        if (data.use_bilinear_texturing)                                            
-                            shader_Flat_Texture_Ortho<color_t,true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture_Ortho<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture_Ortho<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Flat_Texture_Ortho<color_t,false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture_Ortho<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture_Ortho<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					}
 				else
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
-						shader_Gouraud<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data); // same as perspective projection
+						shader_Gouraud<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data); // same as perspective projection
 					else
-						shader_Flat<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data); // same as perspective projection
+						shader_Flat<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data); // same as perspective projection
 					}
 				}
 			else
@@ -1734,25 +1876,45 @@ namespace tgx
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
                         {
-                        if (data.use_bilinear_texturing)                                            
-                            shader_Gouraud_Texture<color_t,true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Gouraud_Texture<color_t,false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Gouraud_Texture<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Gouraud_Texture<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					else
                         {
-                        if (data.use_bilinear_texturing)                                                                        
-                            shader_Flat_Texture<color_t,true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                        if (data.use_tiled_textures)
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture<color_t, ZBUFFER_t, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture<color_t, ZBUFFER_t, false, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         else
-                            shader_Flat_Texture<color_t,false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            {
+                            if (data.use_bilinear_texturing)
+                                shader_Flat_Texture<color_t, ZBUFFER_t, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            else
+                                shader_Flat_Texture<color_t, ZBUFFER_t, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+                            }
                         }
 					}
 				else
 					{
 					if (TGX_SHADER_HAS_GOURAUD(raster_type))
-						shader_Gouraud<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						shader_Gouraud<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
 					else
-						shader_Flat<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						shader_Flat<color_t, ZBUFFER_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
 					}
 				}
 			}		
@@ -1760,6 +1922,159 @@ namespace tgx
 
 
 
+	/**
+	* USER DEFINED FRAGMENT SHADER
+	*
+	* Shader object that calls a user supplied functor to compute the color of each pixel. It is
+	* passed to rasterizeTriangle() in place of shader_select() and the call to the functor is
+	* inlined in the span loop:
+	*
+	*     rasterizeTriangle<LX, LY>(V0, V1, V2, ox, oy, data, ShaderFunctor<ZBUFFER, ORTHO, FRAGMENT>(frag));
+	*
+	* (see also Renderer3D::drawTriangleWithShader()).
+	*
+	* - The vertices are RasterizerVertex<VARYINGS> where the member 'var' holds the user defined
+	*   varying parameters. They are interpolated across the triangle (perspective correct when
+	*   ORTHO = false).
+	*
+	* - FRAGMENT is a functor type with a method
+	*
+	*       color_t operator()(const VARYINGS& var, const float w) const
+	*
+	*   that returns the color of the pixel given the interpolated varyings and the depth w
+	*   (1/z with perspective projection and 2 - z with orthographic projection).
+	*
+	* - When ZBUFFER = true, each pixel is depth tested against data.zbuf and the functor is only
+	*   called for the visible ones.
+	*
+	* Only data.im, data.zbuf, data.zmul, data.zoff and data.zepoch are used.
+	**/
+	template<bool ZBUFFER, bool ORTHO, typename FRAGMENT> struct ShaderFunctor
+		{
+		FRAGMENT frag;	// the user functor
+
+		ShaderFunctor(const FRAGMENT& f) : frag(f) {}
+
+		template<typename VARYINGS, typename RASTERIZER_PARAMS>
+		void operator()(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+			const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVertex<VARYINGS>& fP1,
+			const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVertex<VARYINGS>& fP2,
+			const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVertex<VARYINGS>& fP3,
+			const RASTERIZER_PARAMS& data) const
+			{
+			static_assert(sizeof(VARYINGS) % sizeof(float) == 0, "VARYINGS must only contain floats");
+			const int NV = sizeof(VARYINGS) / sizeof(float);
+
+			auto* buf = data.im->data() + offset;
+			auto* zbuf = (ZBUFFER) ? (data.zbuf + offset) : nullptr;
+			const int32_t stride = data.im->stride();
+
+			const uintptr_t end = (uintptr_t)(buf + (ly * stride));
+			const int32_t aera = O1 + O2 + O3;
+
+			const float invaera = 1.0f / aera;
+			const float fP1a = fP1.w * invaera;
+			const float fP2a = fP2.w * invaera;
+			const float fP3a = fP3.w * invaera;
+			const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
+
+			// varyings divided by the aera (and multiplied by w for perspective correct interpolation)
+			const float* V1 = (const float*)(&fP1.var);
+			const float* V2 = (const float*)(&fP2.var);
+			const float* V3 = (const float*)(&fP3.var);
+			float A1[NV], A2[NV], A3[NV], dA[NV];
+			for (int k = 0; k < NV; k++)
+				{
+				A1[k] = V1[k] * ((ORTHO) ? invaera : fP1a);
+				A2[k] = V2[k] * ((ORTHO) ? invaera : fP2a);
+				A3[k] = V3[k] * ((ORTHO) ? invaera : fP3a);
+				dA[k] = (dx1 * A1[k]) + (dx2 * A2[k]) + (dx3 * A3[k]);
+				}
+
+			while ((uintptr_t)(buf) < end)
+				{ // iterate over scanlines
+				int32_t bx = 0; // start offset
+				if (O1 < 0)
+					{
+					// we know that dx1 > 0					
+					bx = (-O1 + dx1 - 1) / dx1; // first index where it becomes positive
+					}
+				if (O2 < 0)
+					{
+					if (dx2 <= 0)
+						{
+						if (dy2 <= 0) return;
+						const int32_t by = (-O2 + dy2 - 1) / dy2;
+						O1 += (by * dy1);
+						O2 += (by * dy2);
+						O3 += (by * dy3);
+						const int32_t offs = by * stride;
+						buf += offs;
+						if (ZBUFFER) zbuf += offs;
+						continue;
+						}
+					bx = max(bx, ((-O2 + dx2 - 1) / dx2));
+					}
+				if (O3 < 0)
+					{
+					if (dx3 <= 0)
+						{
+						if (dy3 <= 0) return;
+						const int32_t by = (-O3 + dy3 - 1) / dy3;
+						O1 += (by * dy1);
+						O2 += (by * dy2);
+						O3 += (by * dy3);
+						const int32_t offs = by * stride;
+						buf += offs;
+						if (ZBUFFER) zbuf += offs;
+						continue;
+						}
+					bx = max(bx, ((-O3 + dx3 - 1) / dx3));
+					}
+
+				const int32_t C1 = O1 + (dx1 * bx);
+				int32_t C2 = O2 + (dx2 * bx);
+				int32_t C3 = O3 + (dx3 * bx);
+				float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
+				VARYINGS acc;
+				float* pa = (float*)(&acc);
+				for (int k = 0; k < NV; k++) pa[k] = (C1 * A1[k]) + (C2 * A2[k]) + (C3 * A3[k]);
+
+				while ((bx < lx) && ((C2 | C3) >= 0))
+					{
+					if ((!ZBUFFER) || (depthTest(zbuf[bx], (cw + data.zoff) * data.zmul, data)))
+						{
+						if (ORTHO)
+							{
+							buf[bx] = frag(acc, cw);
+							}
+						else
+							{
+							VARYINGS var;
+							float* pv = (float*)(&var);
+							const float icw = 1.0f / cw;
+							for (int k = 0; k < NV; k++) pv[k] = pa[k] * icw;
+							buf[bx] = frag(var, cw);
+							}
+						}
+					C2 += dx2;
+					C3 += dx3;
+					cw += dw;
+					for (int k = 0; k < NV; k++) pa[k] += dA[k];
+					bx++;
+					}
+
+				O1 += dy1;
+				O2 += dy2;
+				O3 += dy3;
+				buf += stride;
+				if (ZBUFFER) zbuf += stride;
+				}
+			}
+		};
+
+
+
 
 }
 
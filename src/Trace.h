@@ -0,0 +1,243 @@
+/** @file Trace.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+#ifndef _TGX_TRACE_H_
+#define _TGX_TRACE_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+
+
+#if TGX_TRACE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <vector>
+
+
+#ifndef TGX_TRACE_MAX_EVENTS
+    #define TGX_TRACE_MAX_EVENTS (1 << 20) // <- max number of events recorded per thread (the following ones are dropped)
+#endif
+
+
+#define TGX_TRACE_CONCAT2(a, b) a##b
+#define TGX_TRACE_CONCAT(a, b) TGX_TRACE_CONCAT2(a, b)
+
+/** record the time spent in the enclosing scope under 'name' (which must be a string literal) */
+#define TGX_TRACE_SCOPE(name) tgx::TraceScope TGX_TRACE_CONCAT(_tgx_trace_scope_, __LINE__)(name)
+
+
+namespace tgx
+{
+
+
+    /**
+    * Frame timeline tracing.
+    *
+    * The TGX_TRACE_SCOPE(name) macros placed around the main stages of the library (mesh setup,
+    * culling tests, vertex transform, triangle setup, shader spans, blitting, text...) record
+    * the start time and duration of each stage in a per-thread buffer while tracing is active.
+    *
+    * Usage:
+    *
+    *     tgx::traceStart();
+    *     ... draw some frames ...
+    *     tgx::traceStop();
+    *     tgx::traceWrite("frame.json"); // open with chrome://tracing or https://ui.perfetto.dev
+    *
+    * Each thread gets its own track. Buffers of finished threads are reused by the threads
+    * created afterward so the tile workers of Renderer3D keep the same tracks across frames.
+    *
+    * traceStart() and traceWrite() must not be called while other threads are drawing.
+    **/
+
+
+    /** a recorded event (times in ns since traceStart()) */
+    struct TraceEvent
+        {
+        const char* name;
+        int64_t start;
+        int64_t dur;
+        };
+
+
+    /** events recorded by a thread */
+    struct TraceBuffer
+        {
+        int tid;                            // track id
+        bool used;                          // true while a thread is using this buffer
+        std::vector<TraceEvent> events;     // recorded events
+        };
+
+
+    /** global state: list of all the thread buffers */
+    struct TraceState
+        {
+        std::mutex mutex;
+        std::vector<TraceBuffer*> buffers;
+        std::atomic<bool> enabled;
+        std::chrono::steady_clock::time_point origin;
+
+        TraceState() : enabled(false), origin(std::chrono::steady_clock::now()) {}
+
+        ~TraceState() { for (TraceBuffer* b : buffers) delete b; }
+        };
+
+
+    inline TraceState& traceState()
+        {
+        static TraceState state;
+        return state;
+        }
+
+
+    /** take a free buffer (or create a new one) when a thread records its first event, give it back when the thread ends */
+    struct TraceThread
+        {
+        TraceBuffer* buffer;
+
+        TraceThread() : buffer(nullptr)
+            {
+            TraceState& S = traceState();
+            std::lock_guard<std::mutex> lock(S.mutex);
+            for (TraceBuffer* b : S.buffers) { if (!b->used) { buffer = b; break; } }
+            if (buffer == nullptr)
+                {
+                buffer = new TraceBuffer;
+                buffer->tid = (int)S.buffers.size() + 1;
+                S.buffers.push_back(buffer);
+                }
+            buffer->used = true;
+            }
+
+        ~TraceThread()
+            {
+            TraceState& S = traceState();
+            std::lock_guard<std::mutex> lock(S.mutex);
+            buffer->used = false;
+            }
+        };
+
+
+    inline TraceBuffer* traceBuffer()
+        {
+        static thread_local TraceThread thread;
+        return thread.buffer;
+        }
+
+
+    /** current time in ns since traceStart() */
+    inline int64_t traceNow()
+        {
+        return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceState().origin).count();
+        }
+
+
+    /** record the lifetime of the object as an event (when tracing is active) */
+    class TraceScope
+        {
+        public:
+
+            TraceScope(const char* name) : _name(name), _start(traceState().enabled.load(std::memory_order_relaxed) ? traceNow() : -1)
+                {
+                }
+
+            ~TraceScope()
+                {
+                if (_start < 0) return;
+                const int64_t end = traceNow();
+                TraceBuffer* b = traceBuffer();
+                if (b->events.size() < TGX_TRACE_MAX_EVENTS) b->events.push_back({ _name, _start, end - _start });
+                }
+
+        private:
+
+            TraceScope(const TraceScope&) = delete;
+            TraceScope& operator=(const TraceScope&) = delete;
+
+            const char* _name;
+            int64_t _start;
+        };
+
+
+    /** discard all the events recorded so far and start recording. */
+    inline void traceStart()
+        {
+        TraceState& S = traceState();
+        std::lock_guard<std::mutex> lock(S.mutex);
+        for (TraceBuffer* b : S.buffers) b->events.clear();
+        S.origin = std::chrono::steady_clock::now();
+        S.enabled = true;
+        }
+
+
+    /** stop recording (the events recorded are kept until the next call to traceStart()). */
+    inline void traceStop()
+        {
+        traceState().enabled = false;
+        }
+
+
+    /**
+    * Write the events recorded in Chrome trace event format (JSON), one track per thread.
+    * Return false if the file cannot be written.
+    **/
+    inline bool traceWrite(const char* filename)
+        {
+        FILE* f = fopen(filename, "w");
+        if (f == nullptr) return false;
+        TraceState& S = traceState();
+        std::lock_guard<std::mutex> lock(S.mutex);
+        fprintf(f, "{\"traceEvents\":[\n");
+        bool first = true;
+        for (TraceBuffer* b : S.buffers)
+            {
+            if (b->events.size() == 0) continue;
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"tgx thread %d\"}}", (first ? "" : ",\n"), b->tid, b->tid);
+            first = false;
+            for (const TraceEvent& e : b->events)
+                {
+                fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"tgx\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", e.name, b->tid, e.start / 1000.0, e.dur / 1000.0);
+                }
+            }
+        fprintf(f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+        const bool ok = (ferror(f) == 0);
+        return (fclose(f) == 0) && ok;
+        }
+
+
+}
+
+#else
+
+#define TGX_TRACE_SCOPE(name)
+
+#endif
+
+
+#endif
+
+#endif
+
+
+/** end of file */
+
@@ -25,6 +25,7 @@
 #ifdef __cplusplus
 
 #include "Misc.h"
+#include "Trace.h"
 #include "Vec2.h"
 #include "Vec3.h"
 #include "Vec4.h"
@@ -33,7 +34,10 @@
 #include "Box3.h"
 #include "Color.h"
 #include "Image.h"
+#include "Mipmap.h"
 #include "Mesh3D.h"
+#include "MeshLOD.h"
+#include "MeshCluster.h"
 #include "Renderer3D.h"
 
 #endif
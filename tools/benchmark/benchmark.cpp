@@ -0,0 +1,270 @@
+/********************************************************************
+*
+* tgx library: headless desktop benchmark.
+*
+* Render the 3D models bundled with the examples into memory images,
+* at several resolutions and for every shader combination:
+*
+*     (flat / gouraud) x (texture: none / nearest / bilinear) x (zbuffer / no zbuffer) x (perspective / ortho)
+*
+* and report the frames/s, triangles/s and pixels/s in CSV (default)
+* or JSON lines format on stdout so that the results can be compared
+* between versions of the library.
+*
+* usage: benchmark [-t seconds] [-m model] [-r width] [-j]
+*
+*   -t seconds : min. duration of each test (default 0.25s)
+*   -m model   : only run the tests for this model
+*   -r width   : only run the tests for this resolution (160, 320 or 640)
+*   -j         : output JSON lines instead of CSV
+*
+********************************************************************/
+
+#include <tgx.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+// bundled models
+#include "../../examples/Teensy4/3D/characters/3Dmodels/stormtrooper/stormtrooper.h"
+#include "../../examples/Teensy4/3D/characters/3Dmodels/cyborg/cyborg.h"
+#include "../../examples/Teensy4/3D/characters/3Dmodels/dennis/dennis.h"
+#include "../../examples/Teensy4/3D/characters/3Dmodels/sinbad/sinbad.h"
+
+using namespace tgx;
+
+
+// max. image size
+static const int MAXLX = 640;
+static const int MAXLY = 480;
+
+// framebuffer and zbuffer
+static RGB565 fb[MAXLX * MAXLY];
+static float zbuf[MAXLX * MAXLY];
+
+// number of orientations of the model (the frames cycle through them)
+static const int NB_ANGLES = 8;
+
+
+
+/*********************************************************************
+* The borg cube (from the borg_cube example): 6 textured quads
+*********************************************************************/
+
+static const fVec3 cube_vertices[8] = { {-1,-1,1}, {1,-1,1}, {1,1,1}, {-1,1,1}, {-1,-1,-1}, {1,-1,-1}, {1,1,-1}, {-1,1,-1} };
+static const fVec3 cube_normals[6] = { {0,0,1}, {1,0,0}, {0,0,-1}, {-1,0,0}, {0,-1,0}, {0,1,0} };
+static const fVec2 cube_texcoords[4] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
+static const uint16_t cube_vert_ind[6 * 4] = { 0,1,2,3,  1,5,6,2,  5,4,7,6,  4,0,3,7,  0,4,5,1,  3,2,6,7 };
+static const uint16_t cube_norm_ind[6 * 4] = { 0,0,0,0,  1,1,1,1,  2,2,2,2,  3,3,3,3,  4,4,4,4,  5,5,5,5 };
+static const uint16_t cube_tex_ind[6 * 4] = { 0,1,2,3,  0,1,2,3,  0,1,2,3,  0,1,2,3,  0,1,2,3,  0,1,2,3 };
+
+static const int CUBE_TEX_SIZE = 128;
+static RGB565 cube_tex_data[CUBE_TEX_SIZE * CUBE_TEX_SIZE];
+static Image<RGB565> cube_texture(cube_tex_data, CUBE_TEX_SIZE, CUBE_TEX_SIZE);
+
+
+/** fill the texture of the cube with a (deterministic) pattern of rectangles. */
+static void initCubeTexture()
+    {
+    cube_texture.fillScreen(RGB565_Blue);
+    uint32_t seed = 12345;
+    for (int k = 0; k < 60; k++)
+        {
+        seed = seed * 1103515245 + 12345; const int x = (seed >> 8) % CUBE_TEX_SIZE;
+        seed = seed * 1103515245 + 12345; const int y = (seed >> 8) % CUBE_TEX_SIZE;
+        seed = seed * 1103515245 + 12345; const int s = 4 + (seed >> 8) % 24;
+        seed = seed * 1103515245 + 12345; const RGB565 col((int)((seed >> 8) & 31), (int)((seed >> 13) & 63), (int)((seed >> 19) & 31));
+        cube_texture.fillRect(iBox2(x, x + s, y, y + s), col);
+        }
+    }
+
+
+
+/*********************************************************************
+* Models and shaders
+*********************************************************************/
+
+struct Model
+    {
+    const char* name;                   // name of the model
+    const Mesh3D<RGB565>* mesh;         // mesh (nullptr for the borg cube)
+    float scale;                        // scaling applied to the model
+    };
+
+static const Model models[] =
+    {
+    { "stormtrooper", &stormtrooper, 9.0f },
+    { "cyborg", &cyborg, 9.0f },
+    { "dennis", &dennis, 9.0f },
+    { "sinbad", &sinbad_1, 9.0f },
+    { "borg_cube", nullptr, 5.0f },
+    };
+
+
+struct Shader
+    {
+    const char* name;   // name of the shader
+    int type;           // shader flags
+    bool bilinear;      // use bilinear texturing
+    };
+
+static const Shader shaders[] =
+    {
+    { "flat", TGX_SHADER_FLAT, false },
+    { "gouraud", TGX_SHADER_GOURAUD, false },
+    { "flat_texture", TGX_SHADER_FLAT | TGX_SHADER_TEXTURE, false },
+    { "gouraud_texture", TGX_SHADER_GOURAUD | TGX_SHADER_TEXTURE, false },
+    { "flat_texture_bilinear", TGX_SHADER_FLAT | TGX_SHADER_TEXTURE, true },
+    { "gouraud_texture_bilinear", TGX_SHADER_GOURAUD | TGX_SHADER_TEXTURE, true },
+    };
+
+
+/** number of triangles drawn for a model */
+static int nbTriangles(const Model& model)
+    {
+    if (model.mesh == nullptr) return 12; // 6 quads
+    int nb = 0;
+    for (const Mesh3D<RGB565>* m = model.mesh; m != nullptr; m = m->next) nb += m->nb_faces;
+    return nb;
+    }
+
+
+
+/*********************************************************************
+* Benchmark
+*********************************************************************/
+
+struct Options
+    {
+    double min_time;        // min duration of each test in seconds
+    const char* model;      // model filter (nullptr = all)
+    int width;              // resolution filter (0 = all)
+    bool json;              // output JSON lines instead of CSV
+    };
+
+
+/** zbuffer methods can only be called when the renderer uses a zbuffer */
+template<int LX, int LY, bool ORTHO> static void setZbuffer(Renderer3D<RGB565, LX, LY, true, ORTHO>& renderer) { renderer.setZbuffer(zbuf, LX * LY); }
+template<int LX, int LY, bool ORTHO> static void setZbuffer(Renderer3D<RGB565, LX, LY, false, ORTHO>&) {}
+template<int LX, int LY, bool ORTHO> static void clearZbuffer(Renderer3D<RGB565, LX, LY, true, ORTHO>& renderer) { renderer.clearZbuffer(); }
+template<int LX, int LY, bool ORTHO> static void clearZbuffer(Renderer3D<RGB565, LX, LY, false, ORTHO>&) {}
+
+
+/** draw a frame with the model in orientation 'angle' */
+template<typename RENDERER>
+static void drawFrame(RENDERER& renderer, Image<RGB565>& im, const Model& model, const Shader& shader, int angle)
+    {
+    im.fillScreen(RGB565_Black);
+    clearZbuffer(renderer);
+    fMat4 M;
+    M.setScale(model.scale, model.scale, model.scale);
+    M.multRotate(angle * (360.0f / NB_ANGLES), { 0,1,0 });
+    M.multRotate(20.0f, { 1,0,0 });
+    M.multTranslate({ 0, 0, -25 });
+    renderer.setModelMatrix(M);
+    if (model.mesh)
+        renderer.drawMesh(shader.type, model.mesh, false);
+    else
+        renderer.drawQuads(shader.type, 6, cube_vert_ind, cube_vertices, cube_norm_ind, cube_normals, cube_tex_ind, cube_texcoords, &cube_texture);
+    }
+
+
+/** run a single test and print the result */
+template<int LX, int LY, bool ZBUFFER, bool ORTHO>
+static void runTest(const Options& opt, const Model& model, const Shader& shader)
+    {
+    Image<RGB565> im(fb, LX, LY);
+    Renderer3D<RGB565, LX, LY, ZBUFFER, ORTHO> renderer;
+    renderer.setImage(&im);
+    setZbuffer(renderer);
+    const float ratio = ((float)LX) / LY;
+    fMat4 P;
+    if (ORTHO)
+        P.setOrtho(-10.35f * ratio, 10.35f * ratio, -10.35f, 10.35f, 0.1f, 1000.0f); // same framing as the perspective projection at z = -25
+    else
+        P.setPerspective(45, ratio, 0.1f, 1000.0f);
+    renderer.setProjectionMatrix(P);
+    renderer.setMaterial(RGBf(0.75f, 0.75f, 0.75f), 0.15f, 0.7f, 0.7f, 32);
+    renderer.useBilinearTexturing(shader.bilinear);
+
+    // untimed pass over all the orientations: warm up and count the pixels covered.
+    int64_t pixels = 0;
+    for (int a = 0; a < NB_ANGLES; a++)
+        {
+        drawFrame(renderer, im, model, shader, a);
+        for (int k = 0; k < LX * LY; k++) { if (fb[k].val != 0) pixels++; }
+        }
+
+    // timed frames: whole cycles of orientations until min_time is elapsed.
+    int64_t frames = 0;
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do
+        {
+        for (int a = 0; a < NB_ANGLES; a++) drawFrame(renderer, im, model, shader, a);
+        frames += NB_ANGLES;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    while (elapsed < opt.min_time);
+
+    const double fps = frames / elapsed;
+    const double tps = fps * nbTriangles(model);
+    const double pps = fps * ((double)pixels / NB_ANGLES);
+    if (opt.json)
+        printf("{\"model\": \"%s\", \"triangles\": %d, \"width\": %d, \"height\": %d, \"shader\": \"%s\", \"zbuffer\": %d, \"ortho\": %d, \"frames\": %lld, \"seconds\": %.4f, \"fps\": %.2f, \"triangles_per_s\": %.0f, \"pixels_per_s\": %.0f}\n",
+            model.name, nbTriangles(model), LX, LY, shader.name, (int)ZBUFFER, (int)ORTHO, (long long)frames, elapsed, fps, tps, pps);
+    else
+        printf("%s,%d,%d,%d,%s,%d,%d,%lld,%.4f,%.2f,%.0f,%.0f\n",
+            model.name, nbTriangles(model), LX, LY, shader.name, (int)ZBUFFER, (int)ORTHO, (long long)frames, elapsed, fps, tps, pps);
+    fflush(stdout);
+    }
+
+
+/** run all the tests at a given resolution */
+template<int LX, int LY>
+static void runResolution(const Options& opt)
+    {
+    static_assert((LX <= MAXLX) && (LY <= MAXLY), "resolution too large");
+    if ((opt.width != 0) && (opt.width != LX)) return;
+    for (const Model& model : models)
+        {
+        if ((opt.model != nullptr) && (strcmp(opt.model, model.name) != 0)) continue;
+        for (const Shader& shader : shaders)
+            {
+            runTest<LX, LY, true, false>(opt, model, shader);
+            runTest<LX, LY, false, false>(opt, model, shader);
+            runTest<LX, LY, true, true>(opt, model, shader);
+            runTest<LX, LY, false, true>(opt, model, shader);
+            }
+        }
+    }
+
+
+int main(int argc, char** argv)
+    {
+    Options opt = { 0.25, nullptr, 0, false };
+    for (int i = 1; i < argc; i++)
+        {
+        if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) opt.min_time = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc)) opt.model = argv[++i];
+        else if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc)) opt.width = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0) opt.json = true;
+        else
+            {
+            fprintf(stderr, "usage: %s [-t seconds] [-m model] [-r width] [-j]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    initCubeTexture();
+    if (!opt.json) printf("model,triangles,width,height,shader,zbuffer,ortho,frames,seconds,fps,triangles_per_s,pixels_per_s\n");
+    runResolution<160, 120>(opt);
+    runResolution<320, 240>(opt);
+    runResolution<640, 480>(opt);
+    return 0;
+    }
+
+
+/** end of file */
@@ -0,0 +1,284 @@
+/********************************************************************
+*
+* tgx library: rasterizer microbenchmark.
+*
+* Feed synthetic triangle soups directly to rasterizeTriangle<LX,LY>()
+* with each shader of Shaders.h and for each color type (RGB565,
+* RGB24, RGB32, RGBf). The soups vary in size (sub-pixel, 10 pixels,
+* 1000 pixels, full screen) and aspect ratio and the triangles have
+* random orientations.
+*
+* The results are reported in ns per triangle and ns per pixel so that
+* setup bound regressions (small triangles) can be told apart from fill
+* bound ones (large triangles). Output is CSV (default) or JSON lines.
+*
+* usage: rasterizer [-t seconds] [-c color] [-s soup] [-f shader] [-j]
+*
+*   -t seconds : min. duration of each test (default 0.1s)
+*   -c color   : only run the tests for this color type (e.g. RGB565)
+*   -s soup    : only run the tests for this soup (e.g. 10px)
+*   -f shader  : only run the shaders whose name contains this string
+*   -j         : output JSON lines instead of CSV
+*
+********************************************************************/
+
+#include <tgx.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+using namespace tgx;
+
+
+// viewport size
+static const int LX = 320;
+static const int LY = 240;
+
+// size of the texture
+static const int TEX_SIZE = 64;
+
+// zbuffer
+static float zbuf[LX * LY];
+
+
+
+/*********************************************************************
+* Triangle soups
+*********************************************************************/
+
+struct Soup
+    {
+    const char* name;   // name of the soup
+    int nb;             // number of triangles
+    float aera;         // aera of each triangle in pixels (0 = full screen)
+    float aspect;       // ratio base/height of the (isoceles) triangles
+    };
+
+static const Soup soups[] =
+    {
+    { "subpixel", 20000, 0.5f, 1.0f },
+    { "10px", 20000, 10.0f, 1.0f },
+    { "10px_thin", 20000, 10.0f, 8.0f },
+    { "1kpx", 1000, 1000.0f, 1.0f },
+    { "1kpx_thin", 1000, 1000.0f, 16.0f },
+    { "fullscreen", 20, 0.0f, 1.0f },
+    };
+
+
+/** deterministic random number in [a, b] */
+static uint32_t seed = 12345;
+static float frand(float a, float b)
+    {
+    seed = seed * 1103515245 + 12345;
+    return a + (b - a) * ((seed >> 8) & 0xFFFF) / 65535.0f;
+    }
+
+
+/** set the random varying parameters of a vertex given its position in pixels */
+static void makeVertex(RasterizerVec4& V, float px, float py)
+    {
+    V.x = (2.0f * px / LX) - 1.0f;
+    V.y = (2.0f * py / LY) - 1.0f;
+    V.z = 0.0f;
+    V.w = frand(0.2f, 1.0f); // 1/w, always in front of the cleared zbuffer
+    V.color = RGBf(frand(0, 1), frand(0, 1), frand(0, 1));
+    V.T = fVec2(frand(0, 1), frand(0, 1));
+    }
+
+
+/**
+* Create the vertices of a soup: isoceles triangles with the given aera and aspect ratio,
+* random orientation and random position inside the viewport. Full screen triangles are
+* equilateral triangles whose incircle contains the whole viewport.
+**/
+static void makeSoup(const Soup& soup, std::vector<RasterizerVec4>& vert)
+    {
+    seed = 12345;
+    vert.resize(3 * soup.nb);
+    for (int k = 0; k < soup.nb; k++)
+        {
+        float lx[3], ly[3];
+        if (soup.aera <= 0)
+            {
+            const float r = 2.0f * sqrtf((float)(LX * LX + LY * LY)) / 2; // twice the inradius
+            for (int i = 0; i < 3; i++) { lx[i] = r * cosf(2.0944f * i); ly[i] = r * sinf(2.0944f * i); }
+            }
+        else
+            {
+            const float b = sqrtf(2 * soup.aera * soup.aspect);
+            const float h = sqrtf(2 * soup.aera / soup.aspect);
+            lx[0] = -b / 2; ly[0] = -h / 3;
+            lx[1] = b / 2;  ly[1] = -h / 3;
+            lx[2] = 0;      ly[2] = 2 * h / 3;
+            }
+        const float a = frand(0, 6.2832f);
+        const float ca = cosf(a), sa = sinf(a);
+        float R = 0;
+        for (int i = 0; i < 3; i++) R = max(R, sqrtf(lx[i] * lx[i] + ly[i] * ly[i]));
+        const float cx = (2 * R < LX) ? frand(R, LX - R) : LX / 2.0f;
+        const float cy = (2 * R < LY) ? frand(R, LY - R) : LY / 2.0f;
+        for (int i = 0; i < 3; i++) makeVertex(vert[3 * k + i], cx + (ca * lx[i]) - (sa * ly[i]), cy + (sa * lx[i]) + (ca * ly[i]));
+        }
+    }
+
+
+/** number of pixels drawn (incremented by the counting shader below) */
+static int64_t pixel_count = 0;
+
+
+/** 'shader' that only counts the pixels inside the triangle. */
+template<typename RASTERIZER_PARAMS>
+static void shader_Count(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+    const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
+    const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
+    const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
+    const RASTERIZER_PARAMS& data)
+    {
+    for (int32_t j = 0; j < ly; j++)
+        {
+        int32_t C1 = O1 + (j * dy1), C2 = O2 + (j * dy2), C3 = O3 + (j * dy3);
+        for (int32_t i = 0; i < lx; i++)
+            {
+            if ((C1 | C2 | C3) >= 0) pixel_count++;
+            C1 += dx1; C2 += dx2; C3 += dx3;
+            }
+        }
+    }
+
+
+
+/*********************************************************************
+* Benchmark
+*********************************************************************/
+
+struct Options
+    {
+    double min_time;        // min duration of each test in seconds
+    const char* color;      // color type filter (nullptr = all)
+    const char* soup;       // soup filter (nullptr = all)
+    const char* shader;     // shader filter (nullptr = all)
+    bool json;              // output JSON lines instead of CSV
+    };
+
+
+/** run a single test and print the result */
+template<typename color_t, typename SHADER_FUNCTION>
+static void runShader(const Options& opt, const char* color_name, const char* shader_name, SHADER_FUNCTION shader_fun, bool zbuffer,
+                      const Soup& soup, const std::vector<RasterizerVec4>& vert, int64_t pixels, RasterizerParams<color_t, color_t, float>& data)
+    {
+    if ((opt.shader != nullptr) && (strstr(shader_name, opt.shader) == nullptr)) return;
+    int64_t passes = 0;
+    double elapsed = 0;
+    do
+        {
+        if (zbuffer) memset(zbuf, 0, sizeof(zbuf));
+        const auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < soup.nb; k++) rasterizeTriangle<LX, LY>(vert[3 * k], vert[3 * k + 1], vert[3 * k + 2], 0, 0, data, shader_fun);
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        passes++;
+        }
+    while (elapsed < opt.min_time);
+
+    const double ns_tri = 1.0e9 * elapsed / ((double)passes * soup.nb);
+    const double ns_pix = 1.0e9 * elapsed / ((double)passes * pixels);
+    if (opt.json)
+        printf("{\"color\": \"%s\", \"shader\": \"%s\", \"soup\": \"%s\", \"triangles\": %d, \"pixels\": %lld, \"passes\": %lld, \"seconds\": %.4f, \"ns_per_triangle\": %.2f, \"ns_per_pixel\": %.3f}\n",
+            color_name, shader_name, soup.name, soup.nb, (long long)pixels, (long long)passes, elapsed, ns_tri, ns_pix);
+    else
+        printf("%s,%s,%s,%d,%lld,%lld,%.4f,%.2f,%.3f\n",
+            color_name, shader_name, soup.name, soup.nb, (long long)pixels, (long long)passes, elapsed, ns_tri, ns_pix);
+    fflush(stdout);
+    }
+
+
+/** run all the tests for a given color type */
+template<typename color_t>
+static void runColor(const Options& opt, const char* color_name)
+    {
+    if ((opt.color != nullptr) && (strcmp(opt.color, color_name) != 0)) return;
+
+    static color_t fb[LX * LY];
+    static color_t tex_data[TEX_SIZE * TEX_SIZE];
+    Image<color_t> im(fb, LX, LY);
+    Image<color_t> tex(tex_data, TEX_SIZE, TEX_SIZE);
+    im.fillScreen(color_t(RGBf(0, 0, 0)));
+    for (int j = 0; j < TEX_SIZE; j++)
+        for (int i = 0; i < TEX_SIZE; i++) tex_data[i + j * TEX_SIZE] = color_t(RGBf(i / (float)TEX_SIZE, j / (float)TEX_SIZE, ((i ^ j) & 8) ? 1.0f : 0.0f));
+
+    RasterizerParams<color_t, color_t, float> data{};
+    data.im = &im;
+    data.zbuf = zbuf;
+    data.zmul = 1.0f;
+    data.zoff = 0.0f;
+    data.facecolor = RGBf(0.5f, 0.75f, 1.0f);
+    data.tex = &tex;
+    data.tex_subspan = 0;
+    data.hiz = nullptr;
+    data.vbuf = nullptr;
+
+    std::vector<RasterizerVec4> vert;
+    for (const Soup& soup : soups)
+        {
+        if ((opt.soup != nullptr) && (strcmp(opt.soup, soup.name) != 0)) continue;
+        makeSoup(soup, vert);
+
+        // untimed pass: count the pixels of the soup.
+        pixel_count = 0;
+        for (int k = 0; k < soup.nb; k++) rasterizeTriangle<LX, LY>(vert[3 * k], vert[3 * k + 1], vert[3 * k + 2], 0, 0, data, shader_Count<RasterizerParams<color_t, color_t, float>>);
+        const int64_t pixels = max<int64_t>(pixel_count, 1);
+
+        runShader(opt, color_name, "Flat", shader_Flat<color_t, float>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud", shader_Gouraud<color_t, float>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture", shader_Flat_Texture<color_t, float, false, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture_Bilinear", shader_Flat_Texture<color_t, float, true, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture", shader_Gouraud_Texture<color_t, float, false, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture_Bilinear", shader_Gouraud_Texture<color_t, float, true, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Zbuffer", shader_Flat_Zbuffer<color_t, float>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Zbuffer", shader_Gouraud_Zbuffer<color_t, float>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture_Zbuffer", shader_Flat_Texture_Zbuffer<color_t, float, false, false>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture_Zbuffer_Bilinear", shader_Flat_Texture_Zbuffer<color_t, float, true, false>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture_Zbuffer", shader_Gouraud_Texture_Zbuffer<color_t, float, false, false>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture_Zbuffer_Bilinear", shader_Gouraud_Texture_Zbuffer<color_t, float, true, false>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture_Ortho", shader_Flat_Texture_Ortho<color_t, float, false, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture_Ortho_Bilinear", shader_Flat_Texture_Ortho<color_t, float, true, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture_Ortho", shader_Gouraud_Texture_Ortho<color_t, float, false, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture_Ortho_Bilinear", shader_Gouraud_Texture_Ortho<color_t, float, true, false>, false, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture_Zbuffer_Ortho", shader_Flat_Texture_Zbuffer_Ortho<color_t, float, false, false>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Flat_Texture_Zbuffer_Ortho_Bilinear", shader_Flat_Texture_Zbuffer_Ortho<color_t, float, true, false>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture_Zbuffer_Ortho", shader_Gouraud_Texture_Zbuffer_Ortho<color_t, float, false, false>, true, soup, vert, pixels, data);
+        runShader(opt, color_name, "Gouraud_Texture_Zbuffer_Ortho_Bilinear", shader_Gouraud_Texture_Zbuffer_Ortho<color_t, float, true, false>, true, soup, vert, pixels, data);
+        }
+    }
+
+
+int main(int argc, char** argv)
+    {
+    Options opt = { 0.1, nullptr, nullptr, nullptr, false };
+    for (int i = 1; i < argc; i++)
+        {
+        if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) opt.min_time = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) opt.color = argv[++i];
+        else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) opt.soup = argv[++i];
+        else if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc)) opt.shader = argv[++i];
+        else if (strcmp(argv[i], "-j") == 0) opt.json = true;
+        else
+            {
+            fprintf(stderr, "usage: %s [-t seconds] [-c color] [-s soup] [-f shader] [-j]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    if (!opt.json) printf("color,shader,soup,triangles,pixels,passes,seconds,ns_per_triangle,ns_per_pixel\n");
+    runColor<RGB565>(opt, "RGB565");
+    runColor<RGB24>(opt, "RGB24");
+    runColor<RGB32>(opt, "RGB32");
+    runColor<RGBf>(opt, "RGBf");
+    return 0;
+    }
+
+
+/** end of file */
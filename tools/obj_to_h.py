@@ -568,7 +568,46 @@ def arraytoString(array):
 # In[ ]:
 
 
-def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color, lightning, BB, BBS):    
+def flatArraytoString(array):
+    return "{\n" + ("\n".join( [ ",".join([str(i) for i in u]) + "," for u in array] )).rstrip(",") + "\n};\n"
+
+
+def quantize(v, vmin, vmax):
+    # map v in [vmin, vmax] to an integer in [0, 65535]
+    if vmax <= vmin:
+        return 0
+    return min(65535, max(0, int(math.floor((v - vmin) * 65535.0 / (vmax - vmin) + 0.5))))
+
+
+def encodeNormalOct(N, bits):
+    # octahedral encoding of a unit normal: x in the high bits, y in the low bits (same as tgx::encodeNormal16/32)
+    s = abs(N[0]) + abs(N[1]) + abs(N[2])
+    x = N[0] / s if s > 0 else 0.0
+    y = N[1] / s if s > 0 else 0.0
+    if N[2] < 0:
+        ox = x
+        x = (1.0 - abs(y)) * (1.0 if ox >= 0 else -1.0)
+        y = (1.0 - abs(ox)) * (1.0 if y >= 0 else -1.0)
+    half = 127.5 if bits == 16 else 32767.5
+    qx = int(math.floor((x + 1.0) * half + 0.5))
+    qy = int(math.floor((y + 1.0) * half + 0.5))
+    return (qx << (bits // 2)) | qy
+
+
+def compactArrays(vertice, texture, normal, normalbits):
+    # quantize the vertices in the model bounding box, the texture coords in their range and encode the normals
+    BB = findBoundingBox(vertice)
+    qvert = [tuple(quantize(u[k], BB[2*k], BB[2*k+1]) - 32768 for k in range(3)) for u in vertice]
+    TB = (0.0, 0.0, 0.0, 0.0)
+    qtex = []
+    if len(texture) > 0:
+        TB = (min(t[0] for t in texture), max(t[0] for t in texture), min(t[1] for t in texture), max(t[1] for t in texture))
+        qtex = [(quantize(t[0], TB[0], TB[1]), quantize(t[1], TB[2], TB[3])) for t in texture]
+    qnorm = [(encodeNormalOct(N, normalbits),) for N in normal]
+    return qvert, BB, qtex, TB, qnorm
+
+
+def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color, lightning, BB, BBS, compact, normalbits):    
     
     NAMESPACE = "tgx" 
     
@@ -589,7 +628,10 @@ def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color,
             tot += len(C)
         return tot
     
-    totKB = len(vertice)*12 + len(normal)*12 + len(texture)*8 + len(R)*68
+    if compact:
+        totKB = len(vertice)*6 + len(normal)*(normalbits//8) + len(texture)*4 + len(R)*80 + 48
+    else:
+        totKB = len(vertice)*12 + len(normal)*12 + len(texture)*8 + len(R)*68
     for O in R:            
         for C in O: 
             elem = 1
@@ -635,20 +677,60 @@ def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color,
         name_vertice = modelname + "_vert_array"
         name_texture = modelname + "_tex_array" if len(texture) > 0 else "nullptr"
         name_normal = modelname + "_norm_array" if len(normal) > 0 else "nullptr"
- 
-        f.write(f"\n\n// vertex array: {(len(vertice)*12)//1024}kb.\n")
-        f.write(f"const {NAMESPACE}::fVec3 {name_vertice}[{len(vertice)}] PROGMEM = ")
-        f.write(arraytoString(vertice))
-    
-        if len(texture) > 0:
-            f.write(f"\n\n// texture array: {(len(texture)*8)//1024}kb.\n")
-            f.write(f"const {NAMESPACE}::fVec2 {name_texture}[{len(texture)}] PROGMEM = ")
-            f.write(arraytoString(texture))
-            
-        if len(normal) > 0:
-            f.write(f"\n\n// normal array: {(len(normal)*12)//1024}kb.\n")
-            f.write(f"const {NAMESPACE}::fVec3 {name_normal}[{len(normal)}] PROGMEM = ")
-            f.write(arraytoString(normal))
+        name_compact = "nullptr"
+
+        if compact:
+            qvert, VB, qtex, TB, qnorm = compactArrays(vertice, texture, normal, normalbits)
+            ntype = "uint16_t" if normalbits == 16 else "uint32_t"
+
+            f.write(f"\n\n// compact vertex array: {(len(vertice)*6)//1024}kb.\n")
+            f.write(f"const int16_t {name_vertice}[{3*len(vertice)}] PROGMEM = ")
+            f.write(flatArraytoString(qvert))
+
+            if len(texture) > 0:
+                f.write(f"\n\n// compact texture array: {(len(texture)*4)//1024}kb.\n")
+                f.write(f"const uint16_t {name_texture}[{2*len(texture)}] PROGMEM = ")
+                f.write(flatArraytoString(qtex))
+
+            if len(normal) > 0:
+                f.write(f"\n\n// compact normal array ({normalbits} bit octahedral encoding): {(len(normal)*(normalbits//8))//1024}kb.\n")
+                f.write(f"const {ntype} {name_normal}[{len(normal)}] PROGMEM = ")
+                f.write(flatArraytoString(qnorm))
+
+            name_compact = "&" + modelname + "_compact"
+            f.write(f"""
+
+// compact vertex attributes (shared by all the objects of the model)
+const {NAMESPACE}::Mesh3DCompact {modelname}_compact PROGMEM =
+    {{
+    {name_vertice}, // quantized vertex array
+    {{ {VB[0]}f, {VB[1]}f, {VB[2]}f, {VB[3]}f, {VB[4]}f, {VB[5]}f }}, // vertex dequantization box
+    {name_texture}, // quantized texture coord array
+    {{ {TB[0]}f, {TB[1]}f, {TB[2]}f, {TB[3]}f }}, // texture coord dequantization box
+    {name_normal if normalbits == 16 else "nullptr"}, // 16 bit normal array
+    {name_normal if normalbits == 32 else "nullptr"} // 32 bit normal array
+    }};
+
+""")
+            # the float arrays are not used
+            name_vertice = "nullptr"
+            name_texture = "nullptr"
+            name_normal = "nullptr"
+
+        else:
+            f.write(f"\n\n// vertex array: {(len(vertice)*12)//1024}kb.\n")
+            f.write(f"const {NAMESPACE}::fVec3 {name_vertice}[{len(vertice)}] PROGMEM = ")
+            f.write(arraytoString(vertice))
+
+            if len(texture) > 0:
+                f.write(f"\n\n// texture array: {(len(texture)*8)//1024}kb.\n")
+                f.write(f"const {NAMESPACE}::fVec2 {name_texture}[{len(texture)}] PROGMEM = ")
+                f.write(arraytoString(texture))
+
+            if len(normal) > 0:
+                f.write(f"\n\n// normal array: {(len(normal)*12)//1024}kb.\n")
+                f.write(f"const {NAMESPACE}::fVec3 {name_normal}[{len(normal)}] PROGMEM = ")
+                f.write(arraytoString(normal))
             
         f.write("\n");
             
@@ -764,7 +846,13 @@ const {NAMESPACE}::Mesh3D<{NAMESPACE}::RGB565> {name} PROGMEM =
     {BBS[mnb][4]}f, {BBS[mnb][5]}f
     }},
     
-    "{modelname}" // model name    
+    "{modelname}", // model name
+
+    nullptr, // lower level of detail
+    nullptr, // texture mip chain
+    {name_compact}, // compact vertex attributes
+    0, // number of clusters
+    nullptr // clusters
     }};
     
 """)                                   
@@ -874,8 +962,15 @@ for i in range(len(obj)):
             texturenames[i] = tname            
     color[i] , lightning[i] = getColorLightning(use_default_cl, i+1)
         
+ans = input("\nstore compact (quantized) vertices/normals/texture coords (y/N) ?")
+compact = True if len(ans) > 0 and (ans.lower())[0] == "y" else False
+normalbits = 32
+if compact and len(normal) > 0:
+    ans = input("- size of the encoded normals: 16 or 32 bits (16/[32]) ?")
+    normalbits = 16 if ans.strip() == "16" else 32
+
 savemodel(vertice, texture, normal, R,
-          modelname, texturenames, tag, color, lightning, BB, BBS)
+          modelname, texturenames, tag, color, lightning, BB, BBS, compact, normalbits)
 
 
 